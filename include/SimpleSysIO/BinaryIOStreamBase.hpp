@@ -8,7 +8,12 @@
 
 #include "IOStreamBase.hpp"
 
+#include <initializer_list>
 #include <memory>
+#include <type_traits>
+
+#include "BytesView.hpp"
+#include "DefaultInitAllocator.hpp"
 
 
 #ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
@@ -18,8 +23,19 @@ namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
 #endif
 {
 
+
+namespace Internal
+{
+struct BinaryIOSRaw;
+} // namespace Internal
+
+
 class RBinaryIOSBase: virtual public IOStreamBase
 {
+public: // static members:
+
+	friend struct Internal::BinaryIOSRaw;
+
 public:
 
 
@@ -45,12 +61,166 @@ public:
 	}
 
 
+	/**
+	 * @brief Read up to `buffer.size()` bytes into the caller-owned buffer,
+	 *        so no container is allocated or initialized
+	 *
+	 * @param buffer The buffer to be filled
+	 * @return The number of bytes read; it may be less than `buffer.size()`
+	 *         if the end of the file is reached
+	 */
+	size_t ReadInto(MutableBytesView buffer)
+	{
+		return ReadBytesRaw(buffer.data(), buffer.size());
+	}
+
+
+	/**
+	 * @brief Read up to `count` bytes and append them to the end of the
+	 *        given container.
+	 *        Clearing and reusing the same container avoids allocations in
+	 *        a read loop; with a container that does not zero-fill on
+	 *        `resize()` (e.g., `UninitBytesVector`), there is no memset
+	 *        either.
+	 *
+	 * @tparam _ContainerType The type of the container
+	 * @param dest The container to append to
+	 * @param count The maximum number of bytes to read
+	 * @return The number of bytes read and appended
+	 */
+	template<typename _ContainerType>
+	size_t ReadInto(_ContainerType& dest, size_t count)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		if (count == 0)
+		{
+			return 0;
+		}
+
+		size_t origSize = dest.size();
+		dest.resize(origSize + count);
+		auto countRead = ReadBytesRaw(&(dest[origSize]), count);
+		dest.resize(origSize + countRead);
+		return countRead;
+	}
+
+
+	/**
+	 * @brief Read up to `count` bytes starting from the given offset.
+	 *        This function neither uses nor moves the current position,
+	 *        so it can be called concurrently on the same stream.
+	 *
+	 * @tparam _ContainerType The type of the container
+	 * @param offset The offset, from the beginning, to read from
+	 * @param count The maximum number of bytes to read
+	 * @return The container storing the bytes read; it may be shorter than
+	 *         `count` if the end of the file is reached
+	 */
+	template<typename _ContainerType>
+	_ContainerType ReadAt(size_t offset, size_t count)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		_ContainerType res;
+		res.resize(count);
+		auto countRead = ReadAtRaw(offset, &(res[0]), count);
+		res.resize(countRead);
+		return res;
+	}
+
+
+	/**
+	 * @brief Scatter read; fill the given segments in order, starting from
+	 *        the current position, with as few calls to the underlying
+	 *        implementation as possible (e.g., one `readv`)
+	 *
+	 * @tparam _SegContainerType The type of the container of segments;
+	 *                           the value type must be `MutableBytesView`
+	 * @param segments The segments to be filled
+	 * @return The total number of bytes read; it may be less than the total
+	 *         size of the segments if the end of the file is reached
+	 */
+	template<typename _SegContainerType>
+	size_t ReadBytesV(const _SegContainerType& segments)
+	{
+		static_assert(
+			std::is_same<
+				typename _SegContainerType::value_type,
+				MutableBytesView
+			>::value,
+			"Segment type must be MutableBytesView"
+		);
+
+		return ReadBytesVRaw(segments.data(), segments.size());
+	}
+
+
+	size_t ReadBytesV(std::initializer_list<MutableBytesView> segments)
+	{
+		return ReadBytesVRaw(segments.begin(), segments.size());
+	}
+
+
+	/**
+	 * @brief Scatter read starting from the given offset; same as
+	 *        `ReadBytesV`, except that the current position is neither used
+	 *        nor moved (e.g., with one `preadv`)
+	 */
+	template<typename _SegContainerType>
+	size_t ReadAtV(size_t offset, const _SegContainerType& segments)
+	{
+		static_assert(
+			std::is_same<
+				typename _SegContainerType::value_type,
+				MutableBytesView
+			>::value,
+			"Segment type must be MutableBytesView"
+		);
+
+		return ReadAtVRaw(offset, segments.data(), segments.size());
+	}
+
+
+	size_t ReadAtV(
+		size_t offset,
+		std::initializer_list<MutableBytesView> segments
+	)
+	{
+		return ReadAtVRaw(offset, segments.begin(), segments.size());
+	}
+
+
 protected:
 
 
 	virtual size_t ReadBytesRaw(void* buffer, size_t size) = 0;
 
 
+	virtual size_t ReadAtRaw(size_t offset, void* buffer, size_t size) = 0;
+
+
+	virtual size_t ReadBytesVRaw(
+		const MutableBytesView* segments,
+		size_t segCount
+	) = 0;
+
+
+	virtual size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) = 0;
+
+
 private:
 
 
@@ -66,10 +236,8 @@ private:
 		if (tillTheEnd)
 		{
 			auto currPos = Tell();
-			Seek(0, SeekWhence::End);
-			auto endPos = Tell();
-			count = endPos - currPos;
-			Seek(currPos);
+			auto endPos = GetFileSize();
+			count = (endPos > currPos) ? (endPos - currPos) : 0;
 		}
 
 		_ContainerType res;
@@ -86,6 +254,10 @@ private:
 
 class WBinaryIOSBase: virtual public IOStreamBase
 {
+public: // static members:
+
+	friend struct Internal::BinaryIOSRaw;
+
 public:
 
 
@@ -113,12 +285,115 @@ public:
 	}
 
 
+	/**
+	 * @brief Write the bytes to the given offset.
+	 *        This function neither uses nor moves the current position,
+	 *        so it can be called concurrently on the same stream.
+	 *        NOTE: on some platforms (e.g., Linux), the offset is ignored
+	 *        if the file is opened in the append mode.
+	 *
+	 * @tparam _ContainerType The type of the container
+	 * @param offset The offset, from the beginning, to write to
+	 * @param bytes The container storing the bytes to be written
+	 */
+	template<typename _ContainerType>
+	void WriteAt(size_t offset, const _ContainerType& bytes)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		WriteAtRaw(offset, bytes.data(), bytes.size());
+	}
+
+
+	/**
+	 * @brief Gather write; write the given segments in order, starting from
+	 *        the current position, with as few calls to the underlying
+	 *        implementation as possible (e.g., one `writev`)
+	 *
+	 * @tparam _SegContainerType The type of the container of segments;
+	 *                           the value type must be `ConstBytesView`
+	 * @param segments The segments to be written
+	 */
+	template<typename _SegContainerType>
+	void WriteBytesV(const _SegContainerType& segments)
+	{
+		static_assert(
+			std::is_same<
+				typename _SegContainerType::value_type,
+				ConstBytesView
+			>::value,
+			"Segment type must be ConstBytesView"
+		);
+
+		WriteBytesVRaw(segments.data(), segments.size());
+	}
+
+
+	void WriteBytesV(std::initializer_list<ConstBytesView> segments)
+	{
+		WriteBytesVRaw(segments.begin(), segments.size());
+	}
+
+
+	/**
+	 * @brief Gather write to the given offset; same as `WriteBytesV`,
+	 *        except that the current position is neither used nor moved
+	 *        (e.g., with one `pwritev`)
+	 */
+	template<typename _SegContainerType>
+	void WriteAtV(size_t offset, const _SegContainerType& segments)
+	{
+		static_assert(
+			std::is_same<
+				typename _SegContainerType::value_type,
+				ConstBytesView
+			>::value,
+			"Segment type must be ConstBytesView"
+		);
+
+		WriteAtVRaw(offset, segments.data(), segments.size());
+	}
+
+
+	void WriteAtV(
+		size_t offset,
+		std::initializer_list<ConstBytesView> segments
+	)
+	{
+		WriteAtVRaw(offset, segments.begin(), segments.size());
+	}
+
+
 protected:
 
 
 	virtual void WriteBytesRaw(const void* buffer, size_t size) = 0;
 
 
+	virtual void WriteAtRaw(
+		size_t offset,
+		const void* buffer,
+		size_t size
+	) = 0;
+
+
+	virtual void WriteBytesVRaw(
+		const ConstBytesView* segments,
+		size_t segCount
+	) = 0;
+
+
+	virtual void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	) = 0;
+
+
 }; // class WBinaryIOSBase
 
 
@@ -137,6 +412,92 @@ public:
 }; // class RWBinaryIOSBase
 
 
+namespace Internal
+{
+
+/**
+ * @brief Access to the raw functions of binary streams, for layers built on
+ *        top of other streams (e.g., buffering decorators) within this
+ *        library.
+ *        NOTE: it is NOT part of the API; users should go through the
+ *        public functions of the streams.
+ */
+struct BinaryIOSRaw
+{
+
+static size_t Read(RBinaryIOSBase& stream, void* buffer, size_t size)
+{
+	return stream.ReadBytesRaw(buffer, size);
+}
+
+static size_t ReadAt(
+	RBinaryIOSBase& stream,
+	size_t offset,
+	void* buffer,
+	size_t size
+)
+{
+	return stream.ReadAtRaw(offset, buffer, size);
+}
+
+static size_t ReadV(
+	RBinaryIOSBase& stream,
+	const MutableBytesView* segments,
+	size_t segCount
+)
+{
+	return stream.ReadBytesVRaw(segments, segCount);
+}
+
+static size_t ReadAtV(
+	RBinaryIOSBase& stream,
+	size_t offset,
+	const MutableBytesView* segments,
+	size_t segCount
+)
+{
+	return stream.ReadAtVRaw(offset, segments, segCount);
+}
+
+static void Write(WBinaryIOSBase& stream, const void* buffer, size_t size)
+{
+	stream.WriteBytesRaw(buffer, size);
+}
+
+static void WriteAt(
+	WBinaryIOSBase& stream,
+	size_t offset,
+	const void* buffer,
+	size_t size
+)
+{
+	stream.WriteAtRaw(offset, buffer, size);
+}
+
+static void WriteV(
+	WBinaryIOSBase& stream,
+	const ConstBytesView* segments,
+	size_t segCount
+)
+{
+	stream.WriteBytesVRaw(segments, segCount);
+}
+
+static void WriteAtV(
+	WBinaryIOSBase& stream,
+	size_t offset,
+	const ConstBytesView* segments,
+	size_t segCount
+)
+{
+	stream.WriteAtVRaw(offset, segments, segCount);
+}
+
+}; // struct BinaryIOSRaw
+
+} // namespace Internal
+
+
 template<typename _ImplType>
 class RBinaryIOSWrapper:
 	virtual public RBinaryIOSBase
@@ -156,11 +517,46 @@ public:
 	virtual size_t Tell() const override
 	{ return m_impl->Tell(); }
 
+	virtual size_t GetFileSize() override
+	{ return m_impl->GetStat().m_size; }
+
+	virtual FileStat GetStat() override
+	{ return m_impl->GetStat(); }
+
+	virtual int GetNativeFD() override
+	{ return m_impl->GetNativeFD(); }
+
 protected:
 
 	virtual size_t ReadBytesRaw(void* buffer, size_t size) override
 	{ return m_impl->ReadBytesRaw(buffer, size); }
 
+	virtual size_t ReadAtRaw(
+		size_t offset,
+		void* buffer,
+		size_t size
+	) override
+	{ return m_impl->ReadAtRaw(offset, buffer, size); }
+
+	virtual size_t ReadBytesVRaw(
+		const MutableBytesView* segments,
+		size_t segCount
+	) override
+	{ return m_impl->ReadBytesVRaw(segments, segCount); }
+
+	virtual size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) override
+	{ return m_impl->ReadAtVRaw(offset, segments, segCount); }
+
+	_ImplType& GetImpl()
+	{ return *m_impl; }
+
+	const _ImplType& GetImpl() const
+	{ return *m_impl; }
+
 private:
 
 	std::unique_ptr<_ImplType> m_impl;
@@ -189,11 +585,46 @@ public:
 	virtual size_t Tell() const override
 	{ return m_impl->Tell(); }
 
+	virtual size_t GetFileSize() override
+	{ return m_impl->GetStat().m_size; }
+
+	virtual FileStat GetStat() override
+	{ return m_impl->GetStat(); }
+
+	virtual int GetNativeFD() override
+	{ return m_impl->GetNativeFD(); }
+
 protected:
 
 	virtual void WriteBytesRaw(const void* buffer, size_t size) override
 	{ m_impl->WriteBytesRaw(buffer, size); }
 
+	virtual void WriteAtRaw(
+		size_t offset,
+		const void* buffer,
+		size_t size
+	) override
+	{ m_impl->WriteAtRaw(offset, buffer, size); }
+
+	virtual void WriteBytesVRaw(
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{ m_impl->WriteBytesVRaw(segments, segCount); }
+
+	virtual void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{ m_impl->WriteAtVRaw(offset, segments, segCount); }
+
+	_ImplType& GetImpl()
+	{ return *m_impl; }
+
+	const _ImplType& GetImpl() const
+	{ return *m_impl; }
+
 private:
 
 	std::unique_ptr<_ImplType> m_impl;
@@ -222,14 +653,69 @@ public:
 	virtual size_t Tell() const override
 	{ return m_impl->Tell(); }
 
+	virtual size_t GetFileSize() override
+	{ return m_impl->GetStat().m_size; }
+
+	virtual FileStat GetStat() override
+	{ return m_impl->GetStat(); }
+
+	virtual int GetNativeFD() override
+	{ return m_impl->GetNativeFD(); }
+
 protected:
 
 	virtual size_t ReadBytesRaw(void* buffer, size_t size) override
 	{ return m_impl->ReadBytesRaw(buffer, size); }
 
+	virtual size_t ReadAtRaw(
+		size_t offset,
+		void* buffer,
+		size_t size
+	) override
+	{ return m_impl->ReadAtRaw(offset, buffer, size); }
+
+	virtual size_t ReadBytesVRaw(
+		const MutableBytesView* segments,
+		size_t segCount
+	) override
+	{ return m_impl->ReadBytesVRaw(segments, segCount); }
+
+	virtual size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) override
+	{ return m_impl->ReadAtVRaw(offset, segments, segCount); }
+
 	virtual void WriteBytesRaw(const void* buffer, size_t size) override
 	{ m_impl->WriteBytesRaw(buffer, size); }
 
+	virtual void WriteAtRaw(
+		size_t offset,
+		const void* buffer,
+		size_t size
+	) override
+	{ m_impl->WriteAtRaw(offset, buffer, size); }
+
+	virtual void WriteBytesVRaw(
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{ m_impl->WriteBytesVRaw(segments, segCount); }
+
+	virtual void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{ m_impl->WriteAtVRaw(offset, segments, segCount); }
+
+	_ImplType& GetImpl()
+	{ return *m_impl; }
+
+	const _ImplType& GetImpl() const
+	{ return *m_impl; }
+
 private:
 
 	std::unique_ptr<_ImplType> m_impl;
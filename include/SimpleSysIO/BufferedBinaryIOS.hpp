@@ -0,0 +1,557 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstring>
+
+#include <memory>
+#include <vector>
+
+#include "BinaryIOStreamBase.hpp"
+#include "Exceptions.hpp"
+#include "Internal/SimpleObjects.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace Internal
+{
+
+/**
+ * @brief Read buffering on top of any read-only binary stream.
+ *        The buffer holds a window of the underlying stream, and the
+ *        position of the underlying stream is always at the end of the
+ *        window, so seeking inside the window does not touch the underlying
+ *        stream at all.
+ */
+class BufferedRImpl
+{
+public: // static members:
+
+	static constexpr size_t sk_defBufferSize = 64 * 1024;
+
+public:
+
+	BufferedRImpl(std::unique_ptr<RBinaryIOSBase> inner, size_t bufferSize) :
+		m_inner(std::move(inner)),
+		m_buffer(),
+		m_bufPos(0),
+		m_bufLen(0),
+		m_cur(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+		if (bufferSize == 0)
+		{
+			throw Exception("Invalid buffer size");
+		}
+
+		m_buffer.resize(bufferSize);
+		m_bufPos = m_inner->Tell();
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		std::ptrdiff_t base = 0;
+		switch (whence)
+		{
+		case SeekWhence::Begin:
+			base = 0;
+			break;
+
+		case SeekWhence::Current:
+			base = Obj::RealNumCast<std::ptrdiff_t>(Tell());
+			break;
+
+		case SeekWhence::End:
+			// the end is only known by the underlying stream
+			m_inner->Seek(offset, whence);
+			ResetWindow(m_inner->Tell());
+			return;
+
+		default:
+			throw Exception("Invalid SeekWhence value");
+		}
+
+		if (offset < -base)
+		{
+			throw Exception("Seeking to a position before the beginning");
+		}
+
+		size_t target = static_cast<size_t>(base + offset);
+		if ((target >= m_bufPos) && (target <= m_bufPos + m_bufLen))
+		{
+			m_cur = target - m_bufPos;
+		}
+		else
+		{
+			m_inner->Seek(Obj::RealNumCast<std::ptrdiff_t>(target));
+			ResetWindow(target);
+		}
+	}
+
+
+	size_t Tell() const
+	{
+		return m_bufPos + m_cur;
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		uint8_t* out = static_cast<uint8_t*>(buffer);
+		size_t readSize = 0;
+
+		while (readSize < size)
+		{
+			size_t avail = m_bufLen - m_cur;
+			if (avail > 0)
+			{
+				size_t copySize = (size - readSize < avail) ?
+					(size - readSize) : avail;
+				std::memcpy(out + readSize, &m_buffer[m_cur], copySize);
+				m_cur += copySize;
+				readSize += copySize;
+				continue;
+			}
+
+			ResetWindow(m_bufPos + m_bufLen);
+
+			size_t remain = size - readSize;
+			if (remain >= m_buffer.size())
+			{
+				// it is not worth going through the buffer
+				size_t directSize = Internal::BinaryIOSRaw::Read(
+					*m_inner,
+					out + readSize,
+					remain
+				);
+				m_bufPos += directSize;
+				readSize += directSize;
+				break;
+			}
+
+			m_bufLen = Internal::BinaryIOSRaw::Read(
+				*m_inner,
+				m_buffer.data(),
+				m_buffer.size()
+			);
+			if (m_bufLen == 0)
+			{
+				// end of the stream
+				break;
+			}
+		}
+
+		return readSize;
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size)
+	{
+		if ((offset >= m_bufPos) && (offset + size <= m_bufPos + m_bufLen))
+		{
+			if (size > 0)
+			{
+				std::memcpy(buffer, &m_buffer[offset - m_bufPos], size);
+			}
+			return size;
+		}
+
+		return Internal::BinaryIOSRaw::ReadAt(*m_inner, offset, buffer, size);
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		size_t readSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			size_t segReadSize =
+				ReadBytesRaw(segments[i].data(), segments[i].size());
+			readSize += segReadSize;
+			if (segReadSize < segments[i].size())
+			{
+				break;
+			}
+		}
+		return readSize;
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	)
+	{
+		return Internal::BinaryIOSRaw::ReadAtV(
+			*m_inner,
+			offset,
+			segments,
+			segCount
+		);
+	}
+
+
+	FileStat GetStat()
+	{
+		return m_inner->GetStat();
+	}
+
+
+	int GetNativeFD() const
+	{
+		// the position of the underlying stream is ahead of this one
+		return -1;
+	}
+
+
+	RBinaryIOSBase& GetInner()
+	{
+		return *m_inner;
+	}
+
+
+	size_t GetBufferSize() const
+	{
+		return m_buffer.size();
+	}
+
+
+private:
+
+	void ResetWindow(size_t pos)
+	{
+		m_bufPos = pos;
+		m_bufLen = 0;
+		m_cur = 0;
+	}
+
+
+	std::unique_ptr<RBinaryIOSBase> m_inner;
+	std::vector<uint8_t> m_buffer;
+	// position of the window in the underlying stream
+	size_t m_bufPos;
+	// number of valid bytes in the window
+	size_t m_bufLen;
+	// current position within the window
+	size_t m_cur;
+
+}; // class BufferedRImpl
+
+
+/**
+ * @brief Write buffering on top of any write-only binary stream.
+ *        Small writes are collected in the buffer, and handed to the
+ *        underlying stream in one call when the buffer is full, or when
+ *        the stream is flushed, seeked, or destroyed.
+ */
+class BufferedWImpl
+{
+public: // static members:
+
+	static constexpr size_t sk_defBufferSize = 64 * 1024;
+
+public:
+
+	BufferedWImpl(std::unique_ptr<WBinaryIOSBase> inner, size_t bufferSize) :
+		m_inner(std::move(inner)),
+		m_buffer(),
+		m_bufPos(0),
+		m_bufLen(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+		if (bufferSize == 0)
+		{
+			throw Exception("Invalid buffer size");
+		}
+
+		m_buffer.resize(bufferSize);
+		m_bufPos = m_inner->Tell();
+	}
+
+
+	~BufferedWImpl()
+	{
+		try
+		{
+			FlushBuffer();
+		}
+		catch (...)
+		{}
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		FlushBuffer();
+		m_inner->Seek(offset, whence);
+		m_bufPos = m_inner->Tell();
+	}
+
+
+	size_t Tell() const
+	{
+		return m_bufPos + m_bufLen;
+	}
+
+
+	void Flush()
+	{
+		FlushBuffer();
+		m_inner->Flush();
+	}
+
+
+	void WriteBytesRaw(const void* buffer, size_t size)
+	{
+		if (size == 0)
+		{
+			return;
+		}
+
+		if (m_bufLen + size > m_buffer.size())
+		{
+			FlushBuffer();
+		}
+
+		if (size >= m_buffer.size())
+		{
+			// it is not worth going through the buffer
+			Internal::BinaryIOSRaw::Write(*m_inner, buffer, size);
+			m_bufPos = m_inner->Tell();
+			return;
+		}
+
+		std::memcpy(&m_buffer[m_bufLen], buffer, size);
+		m_bufLen += size;
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		// pending data must land first, in case the ranges overlap
+		FlushBuffer();
+		Internal::BinaryIOSRaw::WriteAt(*m_inner, offset, buffer, size);
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		size_t totalSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			totalSize += segments[i].size();
+		}
+
+		if (m_bufLen + totalSize > m_buffer.size())
+		{
+			FlushBuffer();
+		}
+
+		if (totalSize >= m_buffer.size())
+		{
+			Internal::BinaryIOSRaw::WriteV(*m_inner, segments, segCount);
+			m_bufPos = m_inner->Tell();
+			return;
+		}
+
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			if (!segments[i].empty())
+			{
+				std::memcpy(
+					&m_buffer[m_bufLen],
+					segments[i].data(),
+					segments[i].size()
+				);
+				m_bufLen += segments[i].size();
+			}
+		}
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		FlushBuffer();
+		Internal::BinaryIOSRaw::WriteAtV(*m_inner, offset, segments, segCount);
+	}
+
+
+	FileStat GetStat()
+	{
+		FlushBuffer();
+		return m_inner->GetStat();
+	}
+
+
+	int GetNativeFD() const
+	{
+		// data in the buffer is not visible through the descriptor
+		return -1;
+	}
+
+
+	/**
+	 * @brief Hand the buffered data to the underlying stream, without
+	 *        flushing the underlying stream itself
+	 */
+	void FlushBuffer()
+	{
+		if (m_bufLen > 0)
+		{
+			Internal::BinaryIOSRaw::Write(*m_inner, m_buffer.data(), m_bufLen);
+			m_bufLen = 0;
+			// re-sync with the underlying stream, since it may be in the
+			// append mode
+			m_bufPos = m_inner->Tell();
+		}
+	}
+
+
+	WBinaryIOSBase& GetInner()
+	{
+		return *m_inner;
+	}
+
+
+	size_t GetBufferSize() const
+	{
+		return m_buffer.size();
+	}
+
+
+private:
+
+	std::unique_ptr<WBinaryIOSBase> m_inner;
+	std::vector<uint8_t> m_buffer;
+	// position of the underlying stream, where the buffered data goes
+	size_t m_bufPos;
+	// number of bytes buffered
+	size_t m_bufLen;
+
+}; // class BufferedWImpl
+
+} // namespace Internal
+
+
+/**
+ * @brief A decorator adding a user-space read buffer to any read-only
+ *        binary stream (e.g., a file descriptor or memory-mapped file),
+ *        so reading small fields one at a time does not turn into one call
+ *        to the underlying stream each.
+ *        Seeking inside the buffered window is served from the buffer.
+ *        NOTE: the underlying stream must not be used directly while it is
+ *        wrapped.
+ */
+class BufferedRBinaryIOS :
+	public RBinaryIOSWrapper<Internal::BufferedRImpl>
+{
+public: // static members:
+
+	using ImplType = Internal::BufferedRImpl;
+	using Base = RBinaryIOSWrapper<ImplType>;
+
+	static constexpr size_t sk_defBufferSize = ImplType::sk_defBufferSize;
+
+public:
+
+	BufferedRBinaryIOS(
+		std::unique_ptr<RBinaryIOSBase> inner,
+		size_t bufferSize = sk_defBufferSize
+	) :
+		Base(
+			Internal::Obj::Internal::make_unique<ImplType>(
+				std::move(inner),
+				bufferSize
+			)
+		)
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~BufferedRBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	size_t GetBufferSize() const
+	{
+		return GetImpl().GetBufferSize();
+	}
+
+}; // class BufferedRBinaryIOS
+
+
+/**
+ * @brief A decorator adding a user-space write buffer to any write-only
+ *        binary stream.
+ *        Buffered data is handed to the underlying stream when the buffer
+ *        is full, or on `Flush`, `Seek`, positional writes, and destruction.
+ *        NOTE: the underlying stream must not be used directly while it is
+ *        wrapped.
+ */
+class BufferedWBinaryIOS :
+	public WBinaryIOSWrapper<Internal::BufferedWImpl>
+{
+public: // static members:
+
+	using ImplType = Internal::BufferedWImpl;
+	using Base = WBinaryIOSWrapper<ImplType>;
+
+	static constexpr size_t sk_defBufferSize = ImplType::sk_defBufferSize;
+
+public:
+
+	BufferedWBinaryIOS(
+		std::unique_ptr<WBinaryIOSBase> inner,
+		size_t bufferSize = sk_defBufferSize
+	) :
+		Base(
+			Internal::Obj::Internal::make_unique<ImplType>(
+				std::move(inner),
+				bufferSize
+			)
+		)
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~BufferedWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	size_t GetBufferSize() const
+	{
+		return GetImpl().GetBufferSize();
+	}
+
+}; // class BufferedWBinaryIOS
+
+
+} // namespace SimpleSysIO
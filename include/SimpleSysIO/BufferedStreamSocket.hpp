@@ -0,0 +1,331 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "BytesView.hpp"
+#include "Endianness.hpp"
+#include "Exceptions.hpp"
+#include "StreamSocketBase.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief A decorator adding receive buffering to any stream socket.
+ *        Each receive from the underlying socket asks for as much as the
+ *        buffer can hold, and the following receives (`RecvPrimitive`,
+ *        `RecvBytes`, `SizedRecvBytes`, etc.) are served from the buffer,
+ *        so parsing many small fields does not cost a system call each.
+ *        Receives larger than the buffer go to the underlying socket
+ *        directly, once the buffered bytes are used up.
+ *        The buffered bytes can be looked at without consuming them (see
+ *        `Peek`).
+ *        Sends are passed through as they are.
+ *        NOTE: asynchronous receives are served from the buffer, right on
+ *        the calling thread, if there are buffered bytes; otherwise, they
+ *        go to the underlying socket, without buffering.
+ *        NOTE: the underlying socket must not be used directly while it is
+ *        wrapped.
+ */
+class BufferedStreamSocket : public StreamSocketBase
+{
+public: // static members:
+
+	static constexpr size_t sk_defBufferSize = 64 * 1024;
+
+public:
+
+	BufferedStreamSocket(
+		std::unique_ptr<StreamSocketBase> inner,
+		size_t bufferSize = sk_defBufferSize
+	) :
+		StreamSocketBase(),
+		m_inner(std::move(inner)),
+		m_buffer(),
+		m_begin(0),
+		m_end(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying socket is not given");
+		}
+		if (bufferSize == 0)
+		{
+			throw Exception("Invalid buffer size");
+		}
+
+		m_buffer.resize(bufferSize);
+	}
+
+
+	// LCOV_EXCL_START
+	virtual ~BufferedStreamSocket() = default;
+	// LCOV_EXCL_STOP
+
+
+	size_t GetBufferSize() const
+	{
+		return m_buffer.size();
+	}
+
+
+	/**
+	 * @brief Get the number of bytes received from the underlying socket
+	 *        but not consumed yet
+	 */
+	size_t GetNumBuffered() const
+	{
+		return m_end - m_begin;
+	}
+
+
+	/**
+	 * @brief Look at the next `size` bytes without consuming them; bytes
+	 *        are received from the underlying socket until there are enough
+	 *        of them in the buffer.
+	 *        NOTE: This function will block until `size` bytes are
+	 *        buffered, or an error occurs.
+	 *
+	 * @exception Exception if `size` is larger than the buffer
+	 *
+	 * @return A view of the bytes, which is only valid until the next
+	 *         receive
+	 */
+	ConstBytesView Peek(size_t size)
+	{
+		if (size > m_buffer.size())
+		{
+			throw Exception("Peeking beyond the size of the buffer");
+		}
+
+		while (GetNumBuffered() < size)
+		{
+			if (m_end == m_buffer.size())
+			{
+				Compact();
+			}
+			if (FillSome() == 0)
+			{
+				throw Exception("The connection is closed");
+			}
+		}
+		return ConstBytesView(&m_buffer[m_begin], size);
+	}
+
+
+	/**
+	 * @brief Look at the next primitive value without consuming it
+	 *        (see `Peek` and `RecvPrimitive`)
+	 */
+	template<
+		typename _T,
+		EndianType _TransmitEndian = EndianType::little
+	>
+	_T PeekPrimitive()
+	{
+		static_assert(std::is_trivially_copyable<_T>::value,
+			"Primitive value type must be trivially copyable");
+
+		ConstBytesView bytes = Peek(sizeof(_T));
+
+		_T res;
+		std::memcpy(&res, bytes.data(), sizeof(_T));
+		return Internal::EndianConvert<
+			_TransmitEndian,
+			EndianType::native
+		>::Primitive(res);
+	}
+
+
+	/**
+	 * @brief Consume (i.e., drop) the next `size` bytes
+	 *        NOTE: This function will block until `size` bytes are
+	 *        received, or an error occurs.
+	 */
+	void Skip(size_t size)
+	{
+		while (size > 0)
+		{
+			if (GetNumBuffered() == 0)
+			{
+				m_begin = 0;
+				m_end = 0;
+				if (FillSome() == 0)
+				{
+					throw Exception("The connection is closed");
+				}
+			}
+
+			size_t skipSize = (size < GetNumBuffered()) ?
+				size : GetNumBuffered();
+			m_begin += skipSize;
+			size -= skipSize;
+		}
+	}
+
+
+	StreamSocketBase& GetInner()
+	{
+		return *m_inner;
+	}
+
+
+	virtual void AsyncSendRaw(
+		std::vector<uint8_t> data,
+		AsyncSendCallback callback
+	) override
+	{
+		m_inner->AsyncSendRaw(std::move(data), std::move(callback));
+	}
+
+
+	virtual void AsyncRecvRawUntilComplete(
+		size_t expSize,
+		AsyncRecvCallback callback
+	) override
+	{
+		if (GetNumBuffered() == 0)
+		{
+			// keep the underlying socket's implementation, which may be
+			// more efficient
+			m_inner->AsyncRecvRawUntilComplete(expSize, std::move(callback));
+		}
+		else
+		{
+			StreamSocketBase::AsyncRecvRawUntilComplete(
+				expSize,
+				std::move(callback)
+			);
+		}
+	}
+
+
+protected:
+
+	virtual size_t SendRaw(const void* data, size_t size) override
+	{
+		return StreamSocketRaw::Send(*m_inner, data, size);
+	}
+
+
+	virtual void SendRawV(
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{
+		StreamSocketRaw::SendV(*m_inner, segments, segCount);
+	}
+
+
+	virtual size_t RecvRaw(void* data, size_t size) override
+	{
+		if (size == 0)
+		{
+			return 0;
+		}
+
+		if (GetNumBuffered() == 0)
+		{
+			m_begin = 0;
+			m_end = 0;
+			if (size >= m_buffer.size())
+			{
+				// it is not worth going through the buffer
+				return StreamSocketRaw::Recv(*m_inner, data, size);
+			}
+			FillSome();
+		}
+
+		return Consume(data, size);
+	}
+
+
+	virtual void AsyncRecvRaw(
+		size_t buffSize,
+		AsyncRecvCallback callback
+	) override
+	{
+		if (GetNumBuffered() == 0)
+		{
+			StreamSocketRaw::AsyncRecv(*m_inner, buffSize, std::move(callback));
+			return;
+		}
+
+		std::vector<uint8_t> data(
+			(buffSize < GetNumBuffered()) ? buffSize : GetNumBuffered()
+		);
+		Consume(data.data(), data.size());
+		callback(std::move(data), false);
+	}
+
+
+private:
+
+	/**
+	 * @brief Receive once from the underlying socket, into the free space
+	 *        at the end of the buffer
+	 */
+	size_t FillSome()
+	{
+		size_t recvSize = StreamSocketRaw::Recv(
+			*m_inner,
+			&m_buffer[m_end],
+			m_buffer.size() - m_end
+		);
+		m_end += recvSize;
+		return recvSize;
+	}
+
+
+	/**
+	 * @brief Move the buffered bytes to the beginning of the buffer
+	 */
+	void Compact()
+	{
+		size_t numBuffered = GetNumBuffered();
+		if ((m_begin > 0) && (numBuffered > 0))
+		{
+			std::memmove(&m_buffer[0], &m_buffer[m_begin], numBuffered);
+		}
+		m_begin = 0;
+		m_end = numBuffered;
+	}
+
+
+	size_t Consume(void* data, size_t size)
+	{
+		size_t copySize = (size < GetNumBuffered()) ? size : GetNumBuffered();
+		if (copySize > 0)
+		{
+			std::memcpy(data, &m_buffer[m_begin], copySize);
+			m_begin += copySize;
+		}
+		return copySize;
+	}
+
+
+	std::unique_ptr<StreamSocketBase> m_inner;
+	std::vector<uint8_t> m_buffer;
+	size_t m_begin;
+	size_t m_end;
+
+}; // class BufferedStreamSocket
+
+
+} // namespace SimpleSysIO
@@ -0,0 +1,184 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief A non-owning, read-only view of a contiguous range of bytes.
+ *        NOTE: the view does not manage the lifetime of the underlying
+ *        memory; it is only valid as long as the object it is obtained
+ *        from is alive.
+ *        It provides the same `value_type`, `data()` and `size()`
+ *        interface as byte containers, so it can be passed to functions
+ *        like `WriteBytes` and `SendBytes` directly.
+ */
+class ConstBytesView
+{
+public: // static members:
+
+	using value_type = uint8_t;
+	using const_iterator = const value_type*;
+
+public:
+
+	ConstBytesView() noexcept :
+		m_data(nullptr),
+		m_size(0)
+	{}
+
+
+	ConstBytesView(const void* data, size_t size) noexcept :
+		m_data(static_cast<const value_type*>(data)),
+		m_size(size)
+	{}
+
+
+	const value_type* data() const noexcept
+	{
+		return m_data;
+	}
+
+
+	size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+
+	bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+
+
+	const_iterator begin() const noexcept
+	{
+		return m_data;
+	}
+
+
+	const_iterator end() const noexcept
+	{
+		return m_data + m_size;
+	}
+
+
+	const value_type& operator[](size_t i) const noexcept
+	{
+		return m_data[i];
+	}
+
+
+	/**
+	 * @brief Copy the bytes in this view into a new container
+	 *
+	 * @tparam _ContainerType The type of the container
+	 * @return The container storing a copy of the bytes
+	 */
+	template<typename _ContainerType>
+	_ContainerType Copy() const
+	{
+		return _ContainerType(begin(), end());
+	}
+
+
+private:
+
+	const value_type* m_data;
+	size_t m_size;
+
+}; // class ConstBytesView
+
+
+/**
+ * @brief A non-owning, writable view of a contiguous range of bytes;
+ *        it is mainly used to describe the destination segments of
+ *        scatter reads.
+ *        NOTE: the view does not manage the lifetime of the underlying
+ *        memory.
+ */
+class MutableBytesView
+{
+public: // static members:
+
+	using value_type = uint8_t;
+	using iterator = value_type*;
+
+public:
+
+	MutableBytesView() noexcept :
+		m_data(nullptr),
+		m_size(0)
+	{}
+
+
+	MutableBytesView(void* data, size_t size) noexcept :
+		m_data(static_cast<value_type*>(data)),
+		m_size(size)
+	{}
+
+
+	value_type* data() const noexcept
+	{
+		return m_data;
+	}
+
+
+	size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+
+	bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+
+
+	iterator begin() const noexcept
+	{
+		return m_data;
+	}
+
+
+	iterator end() const noexcept
+	{
+		return m_data + m_size;
+	}
+
+
+	value_type& operator[](size_t i) const noexcept
+	{
+		return m_data[i];
+	}
+
+
+	operator ConstBytesView() const noexcept
+	{
+		return ConstBytesView(m_data, m_size);
+	}
+
+
+private:
+
+	value_type* m_data;
+	size_t m_size;
+
+}; // class MutableBytesView
+
+} // namespace SimpleSysIO
@@ -0,0 +1,288 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+	(defined(__GNUC__) || defined(__clang__))
+#	include <nmmintrin.h>
+#	define SIMPLESYSIO_CRC32C_X86_GNU
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+#	include <intrin.h>
+#	include <nmmintrin.h>
+#	define SIMPLESYSIO_CRC32C_X86_MSVC
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#	include <arm_acle.h>
+#	define SIMPLESYSIO_CRC32C_ARM
+#endif
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace Internal
+{
+
+/**
+ * @brief Portable CRC32C (Castagnoli), processing 8 bytes per step with
+ *        8 lookup tables (slicing-by-8)
+ */
+struct CRC32CPortable
+{
+	static constexpr uint32_t sk_poly = 0x82F63B78U;
+
+	struct Tables
+	{
+		Tables()
+		{
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t crc = i;
+				for (int j = 0; j < 8; ++j)
+				{
+					crc = (crc >> 1) ^ ((crc & 1U) ? sk_poly : 0U);
+				}
+				m_table[0][i] = crc;
+			}
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				for (size_t t = 1; t < 8; ++t)
+				{
+					uint32_t prev = m_table[t - 1][i];
+					m_table[t][i] = (prev >> 8) ^ m_table[0][prev & 0xFFU];
+				}
+			}
+		}
+
+		uint32_t m_table[8][256];
+	}; // struct Tables
+
+
+	static const Tables& GetTables()
+	{
+		static const Tables sk_tables;
+		return sk_tables;
+	}
+
+
+	/**
+	 * @brief Update the raw (i.e., not inverted) CRC state
+	 */
+	static uint32_t Update(uint32_t state, const uint8_t* data, size_t size)
+	{
+		const Tables& tables = GetTables();
+		const auto& t = tables.m_table;
+
+		while (size >= 8)
+		{
+			uint32_t low = 0;
+			uint32_t high = 0;
+			// assembled byte by byte, so it works on any endianness
+			low = static_cast<uint32_t>(data[0]) |
+				(static_cast<uint32_t>(data[1]) << 8) |
+				(static_cast<uint32_t>(data[2]) << 16) |
+				(static_cast<uint32_t>(data[3]) << 24);
+			high = static_cast<uint32_t>(data[4]) |
+				(static_cast<uint32_t>(data[5]) << 8) |
+				(static_cast<uint32_t>(data[6]) << 16) |
+				(static_cast<uint32_t>(data[7]) << 24);
+			low ^= state;
+
+			state = t[7][low & 0xFFU] ^
+				t[6][(low >> 8) & 0xFFU] ^
+				t[5][(low >> 16) & 0xFFU] ^
+				t[4][low >> 24] ^
+				t[3][high & 0xFFU] ^
+				t[2][(high >> 8) & 0xFFU] ^
+				t[1][(high >> 16) & 0xFFU] ^
+				t[0][high >> 24];
+
+			data += 8;
+			size -= 8;
+		}
+
+		while (size > 0)
+		{
+			state = (state >> 8) ^ t[0][(state ^ *data) & 0xFFU];
+			++data;
+			--size;
+		}
+
+		return state;
+	}
+
+}; // struct CRC32CPortable
+
+
+#if defined(SIMPLESYSIO_CRC32C_X86_GNU) || \
+	defined(SIMPLESYSIO_CRC32C_X86_MSVC)
+
+/**
+ * @brief CRC32C with the SSE4.2 `crc32` instruction
+ */
+struct CRC32CHardware
+{
+	static bool IsSupported()
+	{
+#	if defined(SIMPLESYSIO_CRC32C_X86_GNU)
+		return __builtin_cpu_supports("sse4.2");
+#	else
+		int info[4];
+		__cpuid(info, 1);
+		// ECX bit 20
+		return (info[2] & (1 << 20)) != 0;
+#	endif
+	}
+
+
+#	if defined(SIMPLESYSIO_CRC32C_X86_GNU)
+	__attribute__((target("sse4.2")))
+#	endif
+	static uint32_t Update(uint32_t state, const uint8_t* data, size_t size)
+	{
+#	if defined(__x86_64__) || defined(_M_X64)
+		uint64_t state64 = state;
+		while (size >= 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, data, sizeof(word));
+			state64 = _mm_crc32_u64(state64, word);
+			data += 8;
+			size -= 8;
+		}
+		state = static_cast<uint32_t>(state64);
+#	endif
+		while (size >= 4)
+		{
+			uint32_t word;
+			std::memcpy(&word, data, sizeof(word));
+			state = _mm_crc32_u32(state, word);
+			data += 4;
+			size -= 4;
+		}
+		while (size > 0)
+		{
+			state = _mm_crc32_u8(state, *data);
+			++data;
+			--size;
+		}
+		return state;
+	}
+
+}; // struct CRC32CHardware
+
+#elif defined(SIMPLESYSIO_CRC32C_ARM)
+
+/**
+ * @brief CRC32C with the ARMv8 CRC32 instructions; only used when they are
+ *        enabled at compile time
+ */
+struct CRC32CHardware
+{
+	static bool IsSupported()
+	{
+		return true;
+	}
+
+
+	static uint32_t Update(uint32_t state, const uint8_t* data, size_t size)
+	{
+		while (size >= 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, data, sizeof(word));
+			state = __crc32cd(state, word);
+			data += 8;
+			size -= 8;
+		}
+		while (size > 0)
+		{
+			state = __crc32cb(state, *data);
+			++data;
+			--size;
+		}
+		return state;
+	}
+
+}; // struct CRC32CHardware
+
+#else
+
+struct CRC32CHardware
+{
+	static bool IsSupported()
+	{
+		return false;
+	}
+
+
+	static uint32_t Update(uint32_t state, const uint8_t* data, size_t size)
+	{
+		return CRC32CPortable::Update(state, data, size);
+	}
+
+}; // struct CRC32CHardware
+
+#endif
+
+} // namespace Internal
+
+
+/**
+ * @brief CRC32C (Castagnoli) checksum, as used by iSCSI, ext4, etc.
+ *        The CPU's CRC instructions are used when they are available
+ *        (SSE4.2 on x86, detected at run time; ARMv8 CRC, when enabled at
+ *        compile time), and a table-driven implementation otherwise.
+ */
+struct CRC32C
+{
+
+	/**
+	 * @brief Extend a checksum with more data; `Update(Update(0, a), b)`
+	 *        equals the checksum of `a` followed by `b`
+	 *
+	 * @param crc The checksum of the data before; 0 for the beginning
+	 */
+	static uint32_t Update(uint32_t crc, const void* data, size_t size)
+	{
+		static const bool sk_isHardware =
+			Internal::CRC32CHardware::IsSupported();
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint32_t state = ~crc;
+		state = sk_isHardware ?
+			Internal::CRC32CHardware::Update(state, bytes, size) :
+			Internal::CRC32CPortable::Update(state, bytes, size);
+		return ~state;
+	}
+
+
+	static uint32_t Compute(const void* data, size_t size)
+	{
+		return Update(0, data, size);
+	}
+
+
+	/**
+	 * @brief Whether the CPU's CRC instructions are used
+	 */
+	static bool IsHardwareAccelerated()
+	{
+		return Internal::CRC32CHardware::IsSupported();
+	}
+
+}; // struct CRC32C
+
+
+} // namespace SimpleSysIO
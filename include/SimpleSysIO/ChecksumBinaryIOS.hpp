@@ -0,0 +1,506 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <type_traits>
+
+#include "BinaryIOStreamBase.hpp"
+#include "CRC32C.hpp"
+#include "Endianness.hpp"
+#include "Exceptions.hpp"
+#include "Internal/SimpleObjects.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace Internal
+{
+
+/**
+ * @brief Update a checksum over the first `size` bytes covered by the
+ *        given segments
+ */
+template<typename _SegType>
+inline uint32_t UpdateCRC32CV(
+	uint32_t crc,
+	const _SegType* segments,
+	size_t segCount,
+	size_t size
+)
+{
+	for (size_t i = 0; (i < segCount) && (size > 0); ++i)
+	{
+		size_t segSize =
+			(segments[i].size() < size) ? segments[i].size() : size;
+		crc = CRC32C::Update(crc, segments[i].data(), segSize);
+		size -= segSize;
+	}
+	return crc;
+}
+
+
+/**
+ * @brief Keep a running CRC32C over the bytes read sequentially from any
+ *        read-only binary stream
+ */
+class ChecksumRImpl
+{
+public:
+
+	ChecksumRImpl(std::unique_ptr<RBinaryIOSBase> inner) :
+		m_inner(std::move(inner)),
+		m_crc(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+	}
+
+
+	~ChecksumRImpl() = default;
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		m_inner->Seek(offset, whence);
+	}
+
+
+	size_t Tell() const
+	{
+		return m_inner->Tell();
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		size_t readSize = Internal::BinaryIOSRaw::Read(*m_inner, buffer, size);
+		m_crc = CRC32C::Update(m_crc, buffer, readSize);
+		return readSize;
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size)
+	{
+		return Internal::BinaryIOSRaw::ReadAt(*m_inner, offset, buffer, size);
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		size_t readSize =
+			Internal::BinaryIOSRaw::ReadV(*m_inner, segments, segCount);
+		m_crc = UpdateCRC32CV(m_crc, segments, segCount, readSize);
+		return readSize;
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	)
+	{
+		return Internal::BinaryIOSRaw::ReadAtV(
+			*m_inner,
+			offset,
+			segments,
+			segCount
+		);
+	}
+
+
+	FileStat GetStat()
+	{
+		return m_inner->GetStat();
+	}
+
+
+	int GetNativeFD() const
+	{
+		// reads through the descriptor would not be checksummed
+		return -1;
+	}
+
+
+	uint32_t GetChecksum() const
+	{
+		return m_crc;
+	}
+
+
+	void ResetChecksum(uint32_t crc)
+	{
+		m_crc = crc;
+	}
+
+
+private:
+
+	std::unique_ptr<RBinaryIOSBase> m_inner;
+	uint32_t m_crc;
+
+}; // class ChecksumRImpl
+
+
+/**
+ * @brief Keep a running CRC32C over the bytes written sequentially to any
+ *        write-only binary stream
+ */
+class ChecksumWImpl
+{
+public:
+
+	ChecksumWImpl(std::unique_ptr<WBinaryIOSBase> inner) :
+		m_inner(std::move(inner)),
+		m_crc(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+	}
+
+
+	~ChecksumWImpl() = default;
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		m_inner->Seek(offset, whence);
+	}
+
+
+	size_t Tell() const
+	{
+		return m_inner->Tell();
+	}
+
+
+	void Flush()
+	{
+		m_inner->Flush();
+	}
+
+
+	void WriteBytesRaw(const void* buffer, size_t size)
+	{
+		Internal::BinaryIOSRaw::Write(*m_inner, buffer, size);
+		m_crc = CRC32C::Update(m_crc, buffer, size);
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		Internal::BinaryIOSRaw::WriteAt(*m_inner, offset, buffer, size);
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		Internal::BinaryIOSRaw::WriteV(*m_inner, segments, segCount);
+		m_crc = UpdateCRC32CV(m_crc, segments, segCount, SIZE_MAX);
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		Internal::BinaryIOSRaw::WriteAtV(*m_inner, offset, segments, segCount);
+	}
+
+
+	FileStat GetStat()
+	{
+		return m_inner->GetStat();
+	}
+
+
+	int GetNativeFD() const
+	{
+		// writes through the descriptor would not be checksummed
+		return -1;
+	}
+
+
+	uint32_t GetChecksum() const
+	{
+		return m_crc;
+	}
+
+
+	void ResetChecksum(uint32_t crc)
+	{
+		m_crc = crc;
+	}
+
+
+private:
+
+	std::unique_ptr<WBinaryIOSBase> m_inner;
+	uint32_t m_crc;
+
+}; // class ChecksumWImpl
+
+} // namespace Internal
+
+
+/**
+ * @brief A decorator computing the CRC32C of the data read from any
+ *        read-only binary stream, as it is read, so no second pass over the
+ *        data is needed.
+ *        Only sequential reads (`ReadBytes*`, `ReadInto`) are covered;
+ *        positional reads are passed through as they are, and seeking does
+ *        not affect the checksum.
+ *        NOTE: the underlying stream must not be used directly while it is
+ *        wrapped.
+ */
+class ChecksumRBinaryIOS :
+	public RBinaryIOSWrapper<Internal::ChecksumRImpl>
+{
+public: // static members:
+
+	using ImplType = Internal::ChecksumRImpl;
+	using Base = RBinaryIOSWrapper<ImplType>;
+
+public:
+
+	ChecksumRBinaryIOS(std::unique_ptr<RBinaryIOSBase> inner) :
+		Base(Internal::Obj::Internal::make_unique<ImplType>(std::move(inner)))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~ChecksumRBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Get the CRC32C of all bytes read since the construction (or
+	 *        the last reset)
+	 */
+	uint32_t GetChecksum() const
+	{
+		return GetImpl().GetChecksum();
+	}
+
+
+	void ResetChecksum(uint32_t crc = 0)
+	{
+		GetImpl().ResetChecksum(crc);
+	}
+
+}; // class ChecksumRBinaryIOS
+
+
+/**
+ * @brief A decorator computing the CRC32C of the data written to any
+ *        write-only binary stream, as it is written.
+ *        Only sequential writes (`WriteBytes*`) are covered; positional
+ *        writes are passed through as they are.
+ *        NOTE: the underlying stream must not be used directly while it is
+ *        wrapped.
+ */
+class ChecksumWBinaryIOS :
+	public WBinaryIOSWrapper<Internal::ChecksumWImpl>
+{
+public: // static members:
+
+	using ImplType = Internal::ChecksumWImpl;
+	using Base = WBinaryIOSWrapper<ImplType>;
+
+public:
+
+	ChecksumWBinaryIOS(std::unique_ptr<WBinaryIOSBase> inner) :
+		Base(Internal::Obj::Internal::make_unique<ImplType>(std::move(inner)))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~ChecksumWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Get the CRC32C of all bytes written since the construction (or
+	 *        the last reset)
+	 */
+	uint32_t GetChecksum() const
+	{
+		return GetImpl().GetChecksum();
+	}
+
+
+	void ResetChecksum(uint32_t crc = 0)
+	{
+		GetImpl().ResetChecksum(crc);
+	}
+
+}; // class ChecksumWBinaryIOS
+
+
+/**
+ * @brief Checksummed blocks (frames) in binary streams.
+ *        Each frame is a 4-byte payload size, followed by the 4-byte CRC32C
+ *        of the payload (both in little-endian), followed by the payload.
+ */
+struct ChecksumFrame
+{
+
+	static constexpr size_t sk_headerSize = 8;
+
+	/**
+	 * @brief Payload sizes above this are checked against the bytes left in
+	 *        the stream before the payload is allocated
+	 */
+	static constexpr size_t sk_sizeCheckThreshold = 64 * 1024;
+
+
+	/**
+	 * @brief Write the data as one frame, with one gathered write
+	 */
+	template<typename _ContainerType>
+	static void Write(WBinaryIOSBase& stream, const _ContainerType& data)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		uint8_t header[sk_headerSize];
+		MakeHeader(header, data.data(), data.size());
+
+		stream.WriteBytesV({
+			ConstBytesView(header, sk_headerSize),
+			ConstBytesView(
+				reinterpret_cast<const uint8_t*>(data.data()),
+				data.size()
+			),
+		});
+	}
+
+
+	/**
+	 * @brief Read one frame, and verify its checksum
+	 *
+	 * @exception Exception if the frame is truncated, or the checksum does
+	 *            not match
+	 *
+	 * @param dest Receives the payload of the frame
+	 * @return False if the end of the stream is reached before the frame
+	 */
+	template<typename _ContainerType>
+	static bool Read(RBinaryIOSBase& stream, _ContainerType& dest)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		uint8_t header[sk_headerSize];
+		size_t readSize =
+			stream.ReadInto(MutableBytesView(header, sk_headerSize));
+		if (readSize == 0)
+		{
+			return false;
+		}
+		if (readSize != sk_headerSize)
+		{
+			throw Exception("The checksum frame is truncated");
+		}
+
+		uint32_t size = 0;
+		uint32_t crc = 0;
+		ParseHeader(header, size, crc);
+
+		// the size is not covered by the checksum, so a corrupted one must
+		// not lead to a huge allocation; small ones are not worth the check
+		if (size > sk_sizeCheckThreshold)
+		{
+			size_t fileSize = stream.GetFileSize();
+			size_t pos = stream.Tell();
+			if ((pos > fileSize) || (size > fileSize - pos))
+			{
+				throw Exception("The checksum frame is truncated");
+			}
+		}
+
+		dest.clear();
+		if (stream.ReadInto(dest, size) != size)
+		{
+			throw Exception("The checksum frame is truncated");
+		}
+		Verify(dest.data(), dest.size(), crc);
+		return true;
+	}
+
+
+	static void MakeHeader(uint8_t* header, const void* data, size_t size)
+	{
+		uint32_t sizeLE = Internal::EndianConvert<
+			Internal::Obj::Endian::native,
+			Internal::Obj::Endian::little
+		>::Primitive(Internal::Obj::RealNumCast<uint32_t>(size));
+		uint32_t crcLE = Internal::EndianConvert<
+			Internal::Obj::Endian::native,
+			Internal::Obj::Endian::little
+		>::Primitive(CRC32C::Compute(data, size));
+
+		std::memcpy(header, &sizeLE, sizeof(sizeLE));
+		std::memcpy(header + sizeof(sizeLE), &crcLE, sizeof(crcLE));
+	}
+
+
+	static void ParseHeader(
+		const uint8_t* header,
+		uint32_t& size,
+		uint32_t& crc
+	)
+	{
+		std::memcpy(&size, header, sizeof(size));
+		std::memcpy(&crc, header + sizeof(size), sizeof(crc));
+
+		size = Internal::EndianConvert<
+			Internal::Obj::Endian::little,
+			Internal::Obj::Endian::native
+		>::Primitive(size);
+		crc = Internal::EndianConvert<
+			Internal::Obj::Endian::little,
+			Internal::Obj::Endian::native
+		>::Primitive(crc);
+	}
+
+
+	static void Verify(const void* data, size_t size, uint32_t expCrc)
+	{
+		if (CRC32C::Compute(data, size) != expCrc)
+		{
+			throw Exception("The checksum of the frame does not match");
+		}
+	}
+
+}; // struct ChecksumFrame
+
+
+} // namespace SimpleSysIO
@@ -0,0 +1,228 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstdint>
+
+#include <memory>
+#include <vector>
+
+#include "ChecksumBinaryIOS.hpp"
+#include "CRC32C.hpp"
+#include "Exceptions.hpp"
+#include "StreamSocketBase.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief A decorator computing the CRC32C of the data sent through, and
+ *        received from, any stream socket, as the data goes through, so no
+ *        second pass over the data is needed.
+ *        NOTE: the checksum of received data follows the order in which
+ *        receives complete, so synchronous and asynchronous receives should
+ *        not be outstanding at the same time.
+ *        NOTE: the underlying socket must not be used directly while it is
+ *        wrapped.
+ */
+class ChecksumStreamSocket : public StreamSocketBase
+{
+public:
+
+	ChecksumStreamSocket(std::unique_ptr<StreamSocketBase> inner) :
+		StreamSocketBase(),
+		m_inner(std::move(inner)),
+		m_sendCrc(0),
+		m_recvCrc(0)
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying socket is not given");
+		}
+	}
+
+
+	// LCOV_EXCL_START
+	virtual ~ChecksumStreamSocket() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Get the CRC32C of all bytes sent since the construction (or
+	 *        the last reset)
+	 */
+	uint32_t GetSendChecksum() const
+	{
+		return m_sendCrc;
+	}
+
+
+	/**
+	 * @brief Get the CRC32C of all bytes received since the construction
+	 *        (or the last reset)
+	 */
+	uint32_t GetRecvChecksum() const
+	{
+		return m_recvCrc;
+	}
+
+
+	void ResetSendChecksum(uint32_t crc = 0)
+	{
+		m_sendCrc = crc;
+	}
+
+
+	void ResetRecvChecksum(uint32_t crc = 0)
+	{
+		m_recvCrc = crc;
+	}
+
+
+	StreamSocketBase& GetInner()
+	{
+		return *m_inner;
+	}
+
+
+protected:
+
+	virtual size_t SendRaw(const void* data, size_t size) override
+	{
+		size_t sent = StreamSocketRaw::Send(*m_inner, data, size);
+		m_sendCrc = CRC32C::Update(m_sendCrc, data, sent);
+		return sent;
+	}
+
+
+	virtual void SendRawV(
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{
+		StreamSocketRaw::SendV(*m_inner, segments, segCount);
+		m_sendCrc = Internal::UpdateCRC32CV(
+			m_sendCrc, segments, segCount, SIZE_MAX
+		);
+	}
+
+
+	virtual size_t RecvRaw(void* data, size_t size) override
+	{
+		size_t recv = StreamSocketRaw::Recv(*m_inner, data, size);
+		m_recvCrc = CRC32C::Update(m_recvCrc, data, recv);
+		return recv;
+	}
+
+
+	virtual void AsyncRecvRaw(
+		size_t buffSize,
+		AsyncRecvCallback callback
+	) override
+	{
+		StreamSocketRaw::AsyncRecv(
+			*m_inner,
+			buffSize,
+			[this, callback](std::vector<uint8_t> data, bool hasErrorOccurred)
+			{
+				m_recvCrc =
+					CRC32C::Update(m_recvCrc, data.data(), data.size());
+				callback(std::move(data), hasErrorOccurred);
+			}
+		);
+	}
+
+
+private:
+
+	std::unique_ptr<StreamSocketBase> m_inner;
+	uint32_t m_sendCrc;
+	uint32_t m_recvCrc;
+
+}; // class ChecksumStreamSocket
+
+
+/**
+ * @brief Checksummed blocks (frames) over stream sockets; the format is the
+ *        same as the one of `ChecksumFrame`.
+ */
+struct ChecksumSocketFrame
+{
+
+	static constexpr size_t sk_defMaxSize = 16 * 1024 * 1024;
+
+
+	/**
+	 * @brief Send the data as one frame, with one gathered send
+	 */
+	template<typename _ContainerType>
+	static void Send(StreamSocketBase& sock, const _ContainerType& data)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		uint8_t header[ChecksumFrame::sk_headerSize];
+		ChecksumFrame::MakeHeader(header, data.data(), data.size());
+
+		sock.SendBytesV({
+			ConstBytesView(header, sizeof(header)),
+			ConstBytesView(
+				reinterpret_cast<const uint8_t*>(data.data()),
+				data.size()
+			),
+		});
+	}
+
+
+	/**
+	 * @brief Receive one frame, and verify its checksum
+	 *        NOTE: once an exception is thrown, the connection is no longer
+	 *        at a frame boundary, and should be closed.
+	 *
+	 * @exception Exception if the checksum does not match, or the frame is
+	 *            larger than `maxSize`
+	 *
+	 * @param maxSize The largest payload accepted; the size comes from the
+	 *                peer and is not covered by the checksum, so it is
+	 *                checked before anything is allocated
+	 */
+	template<typename _ContainerType>
+	static _ContainerType Recv(
+		StreamSocketBase& sock,
+		size_t maxSize = sk_defMaxSize
+	)
+	{
+		uint8_t header[ChecksumFrame::sk_headerSize];
+		sock.RecvInto(MutableBytesView(header, sizeof(header)));
+
+		uint32_t size = 0;
+		uint32_t crc = 0;
+		ChecksumFrame::ParseHeader(header, size, crc);
+		if (size > maxSize)
+		{
+			throw Exception("The checksum frame is too large");
+		}
+
+		_ContainerType res;
+		if (size > 0)
+		{
+			res = sock.RecvBytes<_ContainerType>(size);
+		}
+		ChecksumFrame::Verify(res.data(), res.size(), crc);
+		return res;
+	}
+
+}; // struct ChecksumSocketFrame
+
+
+} // namespace SimpleSysIO
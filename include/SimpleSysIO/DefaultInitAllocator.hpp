@@ -0,0 +1,100 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstdint>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief An allocator adaptor that default-initializes elements, instead of
+ *        value-initializing them, when they are constructed without
+ *        arguments. For trivial types like `uint8_t`, this means
+ *        `resize()` on a container using this allocator leaves the new
+ *        memory uninitialized, rather than zero-filling it right before it
+ *        gets overwritten by a read.
+ *
+ * @tparam _T The type of the elements
+ * @tparam _BaseAlloc The allocator used for the actual memory management
+ */
+template<typename _T, typename _BaseAlloc = std::allocator<_T> >
+class DefaultInitAllocator : public _BaseAlloc
+{
+	using _BaseTraits = std::allocator_traits<_BaseAlloc>;
+
+public: // static members:
+
+	template<typename _U>
+	struct rebind
+	{
+		using other = DefaultInitAllocator<
+			_U,
+			typename _BaseTraits::template rebind_alloc<_U>
+		>;
+	}; // struct rebind
+
+public:
+
+	using _BaseAlloc::_BaseAlloc;
+
+
+	DefaultInitAllocator() = default;
+
+
+	template<typename _U>
+	DefaultInitAllocator(
+		const DefaultInitAllocator<
+			_U,
+			typename _BaseTraits::template rebind_alloc<_U>
+		>& other
+	) noexcept :
+		_BaseAlloc(other)
+	{}
+
+
+	template<typename _U>
+	void construct(_U* ptr)
+		noexcept(std::is_nothrow_default_constructible<_U>::value)
+	{
+		::new(static_cast<void*>(ptr)) _U;
+	}
+
+
+	template<typename _U, typename... _Args>
+	void construct(_U* ptr, _Args&&... args)
+	{
+		_BaseTraits::construct(
+			static_cast<_BaseAlloc&>(*this),
+			ptr,
+			std::forward<_Args>(args)...
+		);
+	}
+
+}; // class DefaultInitAllocator
+
+
+/**
+ * @brief A byte vector whose `resize()` does not zero-fill new bytes;
+ *        useful as the destination of reads, e.g., with `ReadInto` and
+ *        `RecvInto`
+ */
+using UninitBytesVector = std::vector<uint8_t, DefaultInitAllocator<uint8_t> >;
+
+
+} // namespace SimpleSysIO
@@ -9,6 +9,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <chrono>
+
 
 #ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
 namespace SimpleSysIO
@@ -24,6 +26,19 @@ enum class SeekWhence : uint8_t
 	End     = 2,
 }; // enum class SeekWhence
 
+/**
+ * @brief Metadata of a file
+ */
+struct FileStat
+{
+	// size of the file in bytes
+	size_t m_size;
+	// preferred block size for efficient I/O; 0 if it is unknown
+	size_t m_blockSize;
+	// time of the last modification
+	std::chrono::system_clock::time_point m_modifiedTime;
+}; // struct FileStat
+
 class IOStreamBase
 {
 public:
@@ -50,6 +65,35 @@ public:
 		return fileSize;
 	}
 
+	/**
+	 * @brief Get the metadata of the file.
+	 *        Implementations backed by a file answer it with a single
+	 *        `fstat`; this default one only knows the size.
+	 */
+	virtual FileStat GetStat()
+	{
+		FileStat res;
+		res.m_size = GetFileSize();
+		res.m_blockSize = 0;
+		res.m_modifiedTime = std::chrono::system_clock::time_point();
+		return res;
+	}
+
+	/**
+	 * @brief Get the OS file descriptor backing the stream, so operations
+	 *        can be done by the kernel directly (e.g., copying between
+	 *        files).
+	 *        NOTE: data buffered by the stream is not visible through the
+	 *        descriptor; flush the stream first.
+	 *
+	 * @return The file descriptor, or -1 if the stream is not backed by
+	 *         one that can be used directly
+	 */
+	virtual int GetNativeFD()
+	{
+		return -1;
+	}
+
 }; // class IOStreamBase
 
 } // namespace SimpleSysIO
@@ -0,0 +1,454 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BinaryIOStreamBase.hpp"
+#include "DefaultInitAllocator.hpp"
+#include "Exceptions.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief The order in which `ParallelChunkReader` delivers the chunks
+ */
+enum class ChunkOrder : uint8_t
+{
+	/**
+	 * @brief By their offsets, from the beginning to the end
+	 */
+	InOrder,
+	/**
+	 * @brief As soon as each of them is read
+	 */
+	AsCompleted,
+}; // enum class ChunkOrder
+
+
+/**
+ * @brief Read large ranges of a stream with multiple threads.
+ *        The range is split into chunks, which are read concurrently by a
+ *        pool of worker threads using positional reads, so the position of
+ *        the stream is never used or moved; the chunks are delivered to a
+ *        callback on the calling thread.
+ *        To bound the memory usage, only a limited number of chunks are
+ *        read ahead of the delivery.
+ *        NOTE: the stream must support concurrent positional reads, which
+ *        is the case for the file streams in `SysCall`.
+ */
+class ParallelChunkReader
+{
+public: // static members:
+
+	using ChunkType = UninitBytesVector;
+
+	/**
+	 * @brief The callback receiving the chunks; the first argument is the
+	 *        offset of the chunk in the stream. Exceptions thrown by it stop
+	 *        the read, and are propagated to the caller of `Read`.
+	 */
+	using ChunkCallback = std::function<void(size_t, ChunkType)>;
+
+	static constexpr size_t sk_defChunkSize = 8 * 1024 * 1024;
+
+public:
+
+	/**
+	 * @param numThreads The number of worker threads; 0 means the number
+	 *                   of hardware threads
+	 * @param maxChunksInFlight The maximum number of chunks being read or
+	 *                          waiting to be delivered; 0 means twice the
+	 *                          number of worker threads
+	 */
+	ParallelChunkReader(size_t numThreads = 0, size_t maxChunksInFlight = 0) :
+		m_maxChunksInFlight(maxChunksInFlight),
+		m_mutex(),
+		m_taskCond(),
+		m_tasks(),
+		m_isStopping(false),
+		m_workers()
+	{
+		if (numThreads == 0)
+		{
+			numThreads = std::thread::hardware_concurrency();
+			numThreads = (numThreads == 0) ? 1 : numThreads;
+		}
+		if (m_maxChunksInFlight == 0)
+		{
+			m_maxChunksInFlight = numThreads * 2;
+		}
+
+		try
+		{
+			for (size_t i = 0; i < numThreads; ++i)
+			{
+				m_workers.emplace_back(&ParallelChunkReader::WorkerMain, this);
+			}
+		}
+		catch (...)
+		{
+			Stop();
+			throw;
+		}
+	}
+
+
+	ParallelChunkReader(const ParallelChunkReader&) = delete;
+
+
+	~ParallelChunkReader()
+	{
+		Stop();
+	}
+
+
+	ParallelChunkReader& operator=(const ParallelChunkReader&) = delete;
+
+
+	/**
+	 * @brief Read `size` bytes starting from `offset`, in chunks of
+	 *        `chunkSize` bytes (the last one may be shorter), and deliver
+	 *        them to `callback`.
+	 *        NOTE: This function will block until all chunks are delivered,
+	 *        or an error occurs; the range is cut at the end of the stream.
+	 *
+	 * @exception Exception if a read fails; exceptions thrown by `callback`
+	 *            are propagated as they are
+	 */
+	void Read(
+		RBinaryIOSBase& stream,
+		size_t offset,
+		size_t size,
+		size_t chunkSize,
+		ChunkOrder order,
+		ChunkCallback callback
+	)
+	{
+		if (chunkSize == 0)
+		{
+			throw Exception("Invalid chunk size");
+		}
+
+		size_t fileSize = stream.GetFileSize();
+		if (offset >= fileSize)
+		{
+			return;
+		}
+		if (size > fileSize - offset)
+		{
+			size = fileSize - offset;
+		}
+		const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+
+		std::shared_ptr<Session> session = std::make_shared<Session>();
+		size_t numSubmitted = 0;
+		size_t numDelivered = 0;
+		try
+		{
+			while (numDelivered < numChunks)
+			{
+				while ((numSubmitted < numChunks) &&
+					(numSubmitted - numDelivered < m_maxChunksInFlight))
+				{
+					size_t chunkOffset = offset + (numSubmitted * chunkSize);
+					size_t chunkLen = (numSubmitted + 1 < numChunks) ?
+						chunkSize :
+						(size - (numSubmitted * chunkSize));
+					Submit(
+						session, stream, numSubmitted, chunkOffset, chunkLen
+					);
+					++numSubmitted;
+				}
+
+				size_t index = 0;
+				ChunkType chunk = session->Take(order, numDelivered, index);
+				callback(offset + (index * chunkSize), std::move(chunk));
+				++numDelivered;
+			}
+		}
+		catch (...)
+		{
+			// the stream must not be used by the workers after returning
+			session->Cancel();
+			session->WaitForAll(numSubmitted);
+			throw;
+		}
+	}
+
+
+	/**
+	 * @brief Read the entire stream; see the other overload
+	 */
+	void Read(
+		RBinaryIOSBase& stream,
+		ChunkOrder order,
+		ChunkCallback callback,
+		size_t chunkSize = sk_defChunkSize
+	)
+	{
+		Read(
+			stream,
+			0,
+			stream.GetFileSize(),
+			chunkSize,
+			order,
+			std::move(callback)
+		);
+	}
+
+
+	size_t GetNumThreads() const
+	{
+		return m_workers.size();
+	}
+
+
+private:
+
+	/**
+	 * @brief The state shared by the workers and the caller, for one
+	 *        call to `Read`
+	 */
+	struct Session
+	{
+		Session() :
+			m_mutex(),
+			m_cond(),
+			m_ready(),
+			m_numFinished(0),
+			m_error(),
+			m_isCancelled(false)
+		{}
+
+		void Complete(size_t index, ChunkType chunk)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_ready.emplace(index, std::move(chunk));
+				++m_numFinished;
+			}
+			m_cond.notify_all();
+		}
+
+		void Fail(std::exception_ptr error)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_error == nullptr)
+				{
+					m_error = error;
+				}
+				++m_numFinished;
+			}
+			m_cond.notify_all();
+		}
+
+		/**
+		 * @brief Wait for the next chunk to be delivered
+		 *
+		 * @param nextIndex The index of the next chunk in order
+		 * @param index Receives the index of the chunk returned
+		 */
+		ChunkType Take(ChunkOrder order, size_t nextIndex, size_t& index)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cond.wait(
+				lock,
+				[this, order, nextIndex]()
+				{
+					return (m_error != nullptr) ||
+						((order == ChunkOrder::InOrder) ?
+							(m_ready.count(nextIndex) > 0) :
+							!m_ready.empty());
+				}
+			);
+			if (m_error != nullptr)
+			{
+				std::rethrow_exception(m_error);
+			}
+
+			auto it = (order == ChunkOrder::InOrder) ?
+				m_ready.find(nextIndex) :
+				m_ready.begin();
+			index = it->first;
+			ChunkType chunk = std::move(it->second);
+			m_ready.erase(it);
+			return chunk;
+		}
+
+		void Cancel()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isCancelled = true;
+		}
+
+		bool IsCancelled()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_isCancelled;
+		}
+
+		/**
+		 * @brief Wait until all submitted tasks have finished
+		 */
+		void WaitForAll(size_t numSubmitted)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cond.wait(
+				lock,
+				[this, numSubmitted]()
+				{
+					return m_numFinished >= numSubmitted;
+				}
+			);
+		}
+
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		std::map<size_t, ChunkType> m_ready;
+		// chunks read, failed, or skipped after the cancellation
+		size_t m_numFinished;
+		std::exception_ptr m_error;
+		bool m_isCancelled;
+	}; // struct Session
+
+
+	static void ReadChunk(
+		const std::shared_ptr<Session>& session,
+		RBinaryIOSBase& stream,
+		size_t index,
+		size_t offset,
+		size_t size
+	)
+	{
+		if (session->IsCancelled())
+		{
+			session->Fail(nullptr);
+			return;
+		}
+
+		try
+		{
+			ChunkType chunk;
+			chunk.resize(size);
+			size_t readSize = 0;
+			while (readSize < size)
+			{
+				size_t res = Internal::BinaryIOSRaw::ReadAt(
+					stream,
+					offset + readSize,
+					chunk.data() + readSize,
+					size - readSize
+				);
+				if (res == 0)
+				{
+					break;
+				}
+				readSize += res;
+			}
+			// the stream may have been truncated meanwhile
+			chunk.resize(readSize);
+
+			session->Complete(index, std::move(chunk));
+		}
+		catch (...)
+		{
+			session->Fail(std::current_exception());
+		}
+	}
+
+
+	void Submit(
+		const std::shared_ptr<Session>& session,
+		RBinaryIOSBase& stream,
+		size_t index,
+		size_t offset,
+		size_t size
+	)
+	{
+		RBinaryIOSBase* streamPtr = &stream;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.emplace_back(
+				[session, streamPtr, index, offset, size]()
+				{
+					ReadChunk(session, *streamPtr, index, offset, size);
+				}
+			);
+		}
+		m_taskCond.notify_one();
+	}
+
+
+	void WorkerMain()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_taskCond.wait(
+					lock,
+					[this]()
+					{
+						return m_isStopping || !m_tasks.empty();
+					}
+				);
+				if (m_tasks.empty())
+				{
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_taskCond.notify_all();
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+		m_workers.clear();
+	}
+
+
+	size_t m_maxChunksInFlight;
+
+	std::mutex m_mutex;
+	std::condition_variable m_taskCond;
+	std::deque<std::function<void()> > m_tasks;
+	bool m_isStopping;
+	std::vector<std::thread> m_workers;
+
+}; // class ParallelChunkReader
+
+
+} // namespace SimpleSysIO
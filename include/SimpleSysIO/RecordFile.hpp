@@ -0,0 +1,546 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "BinaryIOStreamBase.hpp"
+#include "Endianness.hpp"
+#include "Exceptions.hpp"
+#include "Internal/SimpleObjects.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+/**
+ * @brief The layout of record files.
+ *        Each record is framed the same way as `SizedSendBytes` frames data
+ *        on sockets: a 64-bit little-endian size, followed by the bytes.
+ *        After the last record comes a sparse index, which is the offset of
+ *        every `indexInterval`-th record (i.e., record 0, `indexInterval`,
+ *        `2 * indexInterval`, ...), followed by the trailer.
+ *        All values in the index and the trailer are 64-bit little-endian.
+ */
+struct RecordFileFormat
+{
+	using SizeType = uint64_t;
+
+	static constexpr size_t sk_recHeaderSize = sizeof(SizeType);
+
+	// "SSIOREC1"
+	static constexpr uint64_t sk_magic = 0x3143455253494F53ULL;
+
+	static constexpr size_t sk_defIndexInterval = 16;
+
+
+	/**
+	 * @brief The trailer at the very end of the file
+	 */
+	struct Trailer
+	{
+		static constexpr size_t sk_size = 4 * sizeof(uint64_t);
+
+		uint64_t m_indexOffset;
+		uint64_t m_numRecords;
+		uint64_t m_indexInterval;
+		uint64_t m_magic;
+	}; // struct Trailer
+
+
+	static void EncodeU64(uint8_t* dest, uint64_t val)
+	{
+		val = Internal::EndianConvert<
+			Internal::Obj::Endian::native,
+			Internal::Obj::Endian::little
+		>::Primitive(val);
+		std::memcpy(dest, &val, sizeof(val));
+	}
+
+
+	static uint64_t DecodeU64(const uint8_t* src)
+	{
+		uint64_t val = 0;
+		std::memcpy(&val, src, sizeof(val));
+		return Internal::EndianConvert<
+			Internal::Obj::Endian::little,
+			Internal::Obj::Endian::native
+		>::Primitive(val);
+	}
+
+
+	static size_t GetIndexSize(size_t numRecords, size_t indexInterval)
+	{
+		return (numRecords + indexInterval - 1) / indexInterval;
+	}
+
+}; // struct RecordFileFormat
+
+
+/**
+ * @brief Write records to the end of any write-only binary stream, and the
+ *        index when closed.
+ *        NOTE: the file is only readable by `RecordFileReader` after
+ *        `Close()` (or the destruction), since that is when the index is
+ *        written.
+ */
+class RecordFileWriter
+{
+public: // static members:
+
+	using Format = RecordFileFormat;
+
+	static constexpr size_t sk_defIndexInterval = Format::sk_defIndexInterval;
+
+public:
+
+	/**
+	 * @param stream The stream to write to; records are located by their
+	 *               offsets from the beginning of the stream, so it should
+	 *               be positioned at where the record file begins (usually
+	 *               a new, empty file)
+	 * @param indexInterval Only the offset of every `indexInterval`-th
+	 *                      record is kept in the index; 1 gives a dense
+	 *                      index, and larger values trade lookup time for
+	 *                      space
+	 */
+	RecordFileWriter(
+		std::unique_ptr<WBinaryIOSBase> stream,
+		size_t indexInterval = sk_defIndexInterval
+	) :
+		m_stream(std::move(stream)),
+		m_indexInterval(indexInterval),
+		m_offset(0),
+		m_numRecords(0),
+		m_index()
+	{
+		if (m_stream == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+		if (m_indexInterval == 0)
+		{
+			throw Exception("Invalid index interval");
+		}
+		m_offset = m_stream->Tell();
+	}
+
+
+	RecordFileWriter(const RecordFileWriter&) = delete;
+	RecordFileWriter& operator=(const RecordFileWriter&) = delete;
+
+
+	~RecordFileWriter()
+	{
+		try
+		{
+			Close();
+		}
+		catch (...)
+		{}
+	}
+
+
+	/**
+	 * @brief Append one record, with one gathered write
+	 */
+	template<typename _ContainerType>
+	void Append(const _ContainerType& data)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		Append(data.data(), data.size());
+	}
+
+
+	void Append(const void* data, size_t size)
+	{
+		ThrowIfClosed();
+
+		uint8_t header[Format::sk_recHeaderSize];
+		Format::EncodeU64(
+			header,
+			Internal::Obj::RealNumCast<Format::SizeType>(size)
+		);
+
+		m_stream->WriteBytesV({
+			ConstBytesView(header, sizeof(header)),
+			ConstBytesView(static_cast<const uint8_t*>(data), size),
+		});
+
+		if ((m_numRecords % m_indexInterval) == 0)
+		{
+			m_index.push_back(m_offset);
+		}
+		m_offset += sizeof(header) + size;
+		++m_numRecords;
+	}
+
+
+	size_t GetNumRecords() const
+	{
+		return m_numRecords;
+	}
+
+
+	/**
+	 * @brief Write the index and the trailer, flush, and close the stream;
+	 *        calling it again has no effect
+	 */
+	void Close()
+	{
+		if (m_stream == nullptr)
+		{
+			return;
+		}
+
+		std::unique_ptr<WBinaryIOSBase> stream = std::move(m_stream);
+
+		std::vector<uint8_t> footer(
+			(m_index.size() * sizeof(uint64_t)) + Format::Trailer::sk_size
+		);
+		uint8_t* ptr = footer.data();
+		for (uint64_t offset : m_index)
+		{
+			Format::EncodeU64(ptr, offset);
+			ptr += sizeof(uint64_t);
+		}
+		Format::EncodeU64(ptr, m_offset);
+		Format::EncodeU64(ptr + 8, m_numRecords);
+		Format::EncodeU64(ptr + 16, m_indexInterval);
+		Format::EncodeU64(ptr + 24, Format::sk_magic);
+
+		stream->WriteBytes(footer);
+		stream->Flush();
+	}
+
+
+private:
+
+	void ThrowIfClosed() const
+	{
+		if (m_stream == nullptr)
+		{
+			throw Exception("The record file has been closed");
+		}
+	}
+
+
+	std::unique_ptr<WBinaryIOSBase> m_stream;
+	size_t m_indexInterval;
+	uint64_t m_offset;
+	uint64_t m_numRecords;
+	std::vector<uint64_t> m_index;
+
+}; // class RecordFileWriter
+
+
+/**
+ * @brief Read records written by `RecordFileWriter` from any read-only
+ *        binary stream.
+ *        `Get` reads any record with positional reads, by looking up the
+ *        index and then skipping fewer than `indexInterval` records; `Next`
+ *        reads records one after another with sequential reads, so it
+ *        benefits from the buffering of the underlying stream.
+ *        The two do not affect each other.
+ */
+class RecordFileReader
+{
+public: // static members:
+
+	using Format = RecordFileFormat;
+
+public:
+
+	/**
+	 * @exception Exception if the stream does not end with a valid index
+	 */
+	RecordFileReader(std::unique_ptr<RBinaryIOSBase> stream) :
+		m_stream(std::move(stream)),
+		m_dataEnd(0),
+		m_numRecords(0),
+		m_indexInterval(0),
+		m_index(),
+		m_nextRecord(0),
+		m_nextOffset(0)
+	{
+		if (m_stream == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+		LoadIndex();
+		SeekRecord(0);
+	}
+
+
+	RecordFileReader(const RecordFileReader&) = delete;
+	RecordFileReader& operator=(const RecordFileReader&) = delete;
+
+
+	~RecordFileReader() = default;
+
+
+	size_t GetNumRecords() const
+	{
+		return m_numRecords;
+	}
+
+
+	/**
+	 * @brief Get the offset of the given record, from the beginning of the
+	 *        stream
+	 */
+	size_t GetRecordOffset(size_t idx)
+	{
+		ThrowIfOutOfRange(idx);
+
+		uint64_t offset = m_index[idx / m_indexInterval];
+		for (size_t i = 0; i < (idx % m_indexInterval); ++i)
+		{
+			offset += Format::sk_recHeaderSize + ReadRecordSize(offset);
+		}
+		return Internal::Obj::RealNumCast<size_t>(offset);
+	}
+
+
+	/**
+	 * @brief Read the given record; neither uses nor moves the position of
+	 *        `Next`
+	 */
+	template<typename _ContainerType>
+	_ContainerType Get(size_t idx)
+	{
+		uint64_t offset = GetRecordOffset(idx);
+		size_t size = ReadRecordSize(offset);
+
+		_ContainerType res;
+		if (size > 0)
+		{
+			res = m_stream->ReadAt<_ContainerType>(
+				Internal::Obj::RealNumCast<size_t>(
+					offset + Format::sk_recHeaderSize
+				),
+				size
+			);
+			if (res.size() != size)
+			{
+				throw Exception("The record is truncated");
+			}
+		}
+		return res;
+	}
+
+
+	/**
+	 * @brief Move the position of `Next` to the given record; `idx` may be
+	 *        the number of records, i.e., the end
+	 */
+	void SeekRecord(size_t idx)
+	{
+		uint64_t offset = m_dataEnd;
+		if (idx != m_numRecords)
+		{
+			offset = GetRecordOffset(idx);
+		}
+
+		m_stream->Seek(Internal::Obj::RealNumCast<std::ptrdiff_t>(offset));
+		m_nextRecord = idx;
+		m_nextOffset = offset;
+	}
+
+
+	/**
+	 * @brief Get the index of the record to be read by `Next`
+	 */
+	size_t TellRecord() const
+	{
+		return m_nextRecord;
+	}
+
+
+	/**
+	 * @brief Read the next record
+	 *
+	 * @param dest Receives the record; its original content is replaced,
+	 *             but its capacity is reused
+	 * @return False if there is no more record
+	 */
+	template<typename _ContainerType>
+	bool Next(_ContainerType& dest)
+	{
+		if (m_nextRecord >= m_numRecords)
+		{
+			return false;
+		}
+
+		uint8_t header[Format::sk_recHeaderSize];
+		if (
+			m_stream->ReadInto(MutableBytesView(header, sizeof(header))) !=
+				sizeof(header)
+		)
+		{
+			throw Exception("The record is truncated");
+		}
+		uint64_t size = Format::DecodeU64(header);
+		ThrowIfBeyondData(m_nextOffset + sizeof(header), size);
+
+		size_t sizeT = Internal::Obj::RealNumCast<size_t>(size);
+		dest.clear();
+		if (m_stream->ReadInto(dest, sizeT) != sizeT)
+		{
+			throw Exception("The record is truncated");
+		}
+
+		++m_nextRecord;
+		m_nextOffset += sizeof(header) + size;
+		return true;
+	}
+
+
+private:
+
+	void LoadIndex()
+	{
+		size_t fileSize = m_stream->GetFileSize();
+		if (fileSize < Format::Trailer::sk_size)
+		{
+			throw Exception("The record file has no valid trailer");
+		}
+
+		uint8_t trailerBytes[Format::Trailer::sk_size];
+		size_t trailerOffset = fileSize - Format::Trailer::sk_size;
+		if (
+			m_stream->ReadAtV(
+				trailerOffset,
+				{ MutableBytesView(trailerBytes, sizeof(trailerBytes)) }
+			) != sizeof(trailerBytes)
+		)
+		{
+			throw Exception("The record file has no valid trailer");
+		}
+
+		Format::Trailer trailer;
+		trailer.m_indexOffset = Format::DecodeU64(trailerBytes);
+		trailer.m_numRecords = Format::DecodeU64(trailerBytes + 8);
+		trailer.m_indexInterval = Format::DecodeU64(trailerBytes + 16);
+		trailer.m_magic = Format::DecodeU64(trailerBytes + 24);
+
+		if (
+			(trailer.m_magic != Format::sk_magic) ||
+			(trailer.m_indexInterval == 0) ||
+			(trailer.m_indexOffset > trailerOffset)
+		)
+		{
+			throw Exception("The record file has no valid trailer");
+		}
+
+		m_dataEnd = trailer.m_indexOffset;
+		m_numRecords = Internal::Obj::RealNumCast<size_t>(
+			trailer.m_numRecords
+		);
+		m_indexInterval = Internal::Obj::RealNumCast<size_t>(
+			trailer.m_indexInterval
+		);
+
+		size_t indexSize =
+			Format::GetIndexSize(m_numRecords, m_indexInterval);
+		if (
+			(trailerOffset - m_dataEnd) / sizeof(uint64_t) != indexSize ||
+			(trailerOffset - m_dataEnd) % sizeof(uint64_t) != 0
+		)
+		{
+			throw Exception("The index of the record file is corrupted");
+		}
+
+		std::vector<uint8_t> indexBytes = m_stream->ReadAt<
+			std::vector<uint8_t>
+		>(
+			Internal::Obj::RealNumCast<size_t>(m_dataEnd),
+			indexSize * sizeof(uint64_t)
+		);
+		if (indexBytes.size() != indexSize * sizeof(uint64_t))
+		{
+			throw Exception("The index of the record file is corrupted");
+		}
+
+		m_index.resize(indexSize);
+		for (size_t i = 0; i < indexSize; ++i)
+		{
+			m_index[i] = Format::DecodeU64(
+				indexBytes.data() + (i * sizeof(uint64_t))
+			);
+			if (m_index[i] >= m_dataEnd)
+			{
+				throw Exception("The index of the record file is corrupted");
+			}
+		}
+	}
+
+
+	size_t ReadRecordSize(uint64_t offset)
+	{
+		uint8_t header[Format::sk_recHeaderSize];
+		if (
+			m_stream->ReadAtV(
+				Internal::Obj::RealNumCast<size_t>(offset),
+				{ MutableBytesView(header, sizeof(header)) }
+			) != sizeof(header)
+		)
+		{
+			throw Exception("The record is truncated");
+		}
+
+		uint64_t size = Format::DecodeU64(header);
+		ThrowIfBeyondData(offset + sizeof(header), size);
+		return Internal::Obj::RealNumCast<size_t>(size);
+	}
+
+
+	void ThrowIfBeyondData(uint64_t dataOffset, uint64_t size) const
+	{
+		if ((dataOffset > m_dataEnd) || (size > (m_dataEnd - dataOffset)))
+		{
+			throw Exception("The record is corrupted");
+		}
+	}
+
+
+	void ThrowIfOutOfRange(size_t idx) const
+	{
+		if (idx >= m_numRecords)
+		{
+			throw Exception("The record index is out of range");
+		}
+	}
+
+
+	std::unique_ptr<RBinaryIOSBase> m_stream;
+	uint64_t m_dataEnd;
+	size_t m_numRecords;
+	size_t m_indexInterval;
+	std::vector<uint64_t> m_index;
+
+	size_t m_nextRecord;
+	uint64_t m_nextOffset;
+
+}; // class RecordFileReader
+
+
+} // namespace SimpleSysIO
@@ -8,13 +8,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <functional>
+#include <initializer_list>
 #include <type_traits>
 #include <vector>
 
 #include <SimpleObjects/RealNumCast.hpp>
 
+#include "BytesView.hpp"
+#include "DefaultInitAllocator.hpp"
 #include "Endianness.hpp"
 
 
@@ -37,6 +41,13 @@ public: //static members:
 
 	using AsyncRecvCallback = std::function<void(std::vector<uint8_t>, bool)>;
 
+	/**
+	 * @brief The callback for asynchronous sends; the first argument is the
+	 *        number of bytes sent, and the second one indicates whether an
+	 *        error has occurred
+	 */
+	using AsyncSendCallback = std::function<void(size_t, bool)>;
+
 	friend struct StreamSocketRaw;
 	friend struct StreamSocketAsync;
 
@@ -73,6 +84,38 @@ public:
 	}
 
 
+	/**
+	 * @brief Gather send; send the given segments in order, with as few
+	 *        calls to the underlying implementation as possible (e.g., one
+	 *        `sendmsg`), so a header and a body go out together.
+	 *        NOTE: This function will block until all data is sent, or an
+	 *        error occurs.
+	 *
+	 * @tparam _SegContainerType The type of the container of segments;
+	 *                           the value type must be `ConstBytesView`
+	 * @param segments The segments to be sent
+	 */
+	template<typename _SegContainerType>
+	void SendBytesV(const _SegContainerType& segments)
+	{
+		static_assert(
+			std::is_same<
+				typename _SegContainerType::value_type,
+				ConstBytesView
+			>::value,
+			"Segment type must be ConstBytesView"
+		);
+
+		SendRawV(segments.data(), segments.size());
+	}
+
+
+	void SendBytesV(std::initializer_list<ConstBytesView> segments)
+	{
+		SendRawV(segments.begin(), segments.size());
+	}
+
+
 	/**
 	 * @brief Receive bytes from the peer and stores it in the container.
 	 *        NOTE:  This function will block and receive data until the
@@ -134,6 +177,97 @@ public:
 	}
 
 
+	/**
+	 * @brief Receive bytes from the peer into the caller-owned buffer,
+	 *        so no container is allocated or initialized.
+	 *        NOTE: This function will block until the buffer is filled, or
+	 *        an error occurs.
+	 *
+	 * @param buffer The buffer to be filled
+	 */
+	void RecvInto(MutableBytesView buffer)
+	{
+		RecvRawUntilComplete(buffer.data(), buffer.size());
+	}
+
+
+	/**
+	 * @brief Receive `dataSize` bytes from the peer and append them to the
+	 *        end of the given container.
+	 *        Clearing and reusing the same container avoids allocations;
+	 *        with a container that does not zero-fill on `resize()`
+	 *        (e.g., `UninitBytesVector`), there is no memset either.
+	 *        NOTE: This function will block until all data is received, or
+	 *        an error occurs.
+	 *
+	 * @tparam _ContainerType The type of the container
+	 * @param dest The container to append to
+	 * @param dataSize The size of the data to be received
+	 */
+	template<typename _ContainerType>
+	void RecvInto(_ContainerType& dest, size_t dataSize)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		if (dataSize == 0)
+		{
+			return;
+		}
+
+		size_t origSize = dest.size();
+		dest.resize(origSize + dataSize);
+		RecvRawUntilComplete(&(dest[origSize]), dataSize);
+	}
+
+
+	/**
+	 * @brief Receive up to `buffer.size()` bytes from the peer into the
+	 *        caller-owned buffer.
+	 *        NOTE: This function will block. However, it may receive no data,
+	 *        or some data, or an error occurs.
+	 *
+	 * @return The number of bytes received
+	 */
+	size_t RecvSomeInto(MutableBytesView buffer)
+	{
+		return RecvRaw(buffer.data(), buffer.size());
+	}
+
+
+	/**
+	 * @brief Receive up to `maxSize` bytes from the peer and append them to
+	 *        the end of the given container.
+	 *        NOTE: This function will block. However, it may receive no data,
+	 *        or some data, or an error occurs.
+	 *
+	 * @return The number of bytes received and appended
+	 */
+	template<typename _ContainerType>
+	size_t RecvSomeInto(_ContainerType& dest, size_t maxSize)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		if (maxSize == 0)
+		{
+			return 0;
+		}
+
+		size_t origSize = dest.size();
+		dest.resize(origSize + maxSize);
+		size_t recvSize = RecvRaw(&(dest[origSize]), maxSize);
+		dest.resize(origSize + recvSize);
+		return recvSize;
+	}
+
+
 	/**
 	 * @brief Send some primitive data, such as `int`, `float`, etc. to the
 	 *        peer; this function should also work for POD (plain old data)
@@ -203,7 +337,8 @@ public:
 
 	/**
 	 * @brief Send the size of the container first, and then send the bytes
-	 *        stored in the container to the peer.
+	 *        stored in the container to the peer; both are sent with one
+	 *        gathered send (see `SendBytesV`).
 	 *        NOTE: This function will block until all data is sent.
 	 *        NOTE: This function is built ON TOP OF the stream protocol, since
 	 *        it sends size of the container first followed by the data.
@@ -222,11 +357,27 @@ public:
 	>
 	void SizedSendBytes(const _ContainerType& data)
 	{
-		_SizeType sizeToSend =
-			Internal::Obj::RealNumCast<_SizeType>(data.size());
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
 
-		SendPrimitive<_SizeType, _TransmitEndian>(sizeToSend);
-		SendBytes<_ContainerType>(data);
+		_SizeType sizeToSend = Internal::EndianConvert<
+			EndianType::native,
+			_TransmitEndian
+		>::Primitive(Internal::Obj::RealNumCast<_SizeType>(data.size()));
+
+		SendBytesV({
+			ConstBytesView(
+				reinterpret_cast<const uint8_t*>(&sizeToSend),
+				sizeof(_SizeType)
+			),
+			ConstBytesView(
+				reinterpret_cast<const uint8_t*>(data.data()),
+				data.size()
+			),
+		});
 	}
 
 
@@ -278,11 +429,16 @@ public:
 		AsyncRecvCallback callback
 	)
 	{
+		std::shared_ptr<std::vector<uint8_t> > cached =
+			std::make_shared<std::vector<uint8_t> >();
+		// so appending the received segments never reallocates
+		cached->reserve(expSize);
+
 		AsyncRecvRawUntilCompleteImpl implCallbackFunctor(
 			this,
 			expSize,
 			std::move(callback),
-			std::make_shared<std::vector<uint8_t> >()
+			std::move(cached)
 		);
 		AsyncRecvCallback implCallback = std::move(implCallbackFunctor);
 
@@ -310,6 +466,149 @@ public:
 		AsyncRecvRawUntilComplete(sizeof(_SizeType), sizeCallback);
 	}
 
+
+	/**
+	 * @brief The very basic interface to send data asynchronously.
+	 *        Data sent by consecutive calls goes out in the order of the
+	 *        calls, and `callback` (if given) is called once all bytes of
+	 *        this piece of data are sent, or an error occurs.
+	 *        The child class implementation should take the ownership of
+	 *        the data until it's sent.
+	 *        NOTE: the default implementation is not asynchronous: it sends
+	 *        the data on the calling thread, and then calls the callback.
+	 *        NOTE: synchronous sends should not be issued on this socket
+	 *        while asynchronous sends are pending.
+	 *
+	 * @param data The data to be sent
+	 * @param callback The callback function; may be empty
+	 */
+	virtual void AsyncSendRaw(
+		std::vector<uint8_t> data,
+		AsyncSendCallback callback
+	)
+	{
+		bool hasErrorOccurred = false;
+		try
+		{
+			SendRawUntilComplete(data.data(), data.size());
+		}
+		catch (...)
+		{
+			hasErrorOccurred = true;
+		}
+
+		if (callback)
+		{
+			callback(hasErrorOccurred ? 0 : data.size(), hasErrorOccurred);
+		}
+	}
+
+
+	/**
+	 * @brief Send bytes stored in the container to the peer asynchronously;
+	 *        the bytes are copied, so the container can be discarded right
+	 *        after the call (see `AsyncSendRaw`)
+	 */
+	template<typename _ContainerType>
+	void AsyncSendBytes(
+		const _ContainerType& data,
+		AsyncSendCallback callback = AsyncSendCallback()
+	)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		const uint8_t* begin = reinterpret_cast<const uint8_t*>(data.data());
+		AsyncSendRaw(
+			std::vector<uint8_t>(begin, begin + data.size()),
+			std::move(callback)
+		);
+	}
+
+
+	/**
+	 * @brief Send the bytes to the peer asynchronously, without copying
+	 *        them (see `AsyncSendRaw`)
+	 */
+	void AsyncSendBytes(
+		std::vector<uint8_t>&& data,
+		AsyncSendCallback callback = AsyncSendCallback()
+	)
+	{
+		AsyncSendRaw(std::move(data), std::move(callback));
+	}
+
+
+	/**
+	 * @brief The asynchronous version of `SendPrimitive`
+	 *        (see `AsyncSendRaw`)
+	 */
+	template<
+		typename _T,
+		EndianType _TransmitEndian = EndianType::little
+	>
+	void AsyncSendPrimitive(
+		const _T& data,
+		AsyncSendCallback callback = AsyncSendCallback()
+	)
+	{
+		static_assert(std::is_trivially_copyable<_T>::value,
+			"Primitive value type must be trivially copyable");
+
+		_T dataToSend = Internal::EndianConvert<
+			EndianType::native,
+			_TransmitEndian
+		>::Primitive(data);
+
+		std::vector<uint8_t> bytes(sizeof(_T));
+		std::memcpy(bytes.data(), &dataToSend, sizeof(_T));
+		AsyncSendRaw(std::move(bytes), std::move(callback));
+	}
+
+
+	/**
+	 * @brief The asynchronous version of `SizedSendBytes`; the size and the
+	 *        bytes are sent as one piece of data, so `callback` is called
+	 *        once, with the number of bytes including the size
+	 *        (see `AsyncSendRaw`)
+	 */
+	template<
+		typename _ContainerType,
+		typename _SizeType = uint64_t,
+		EndianType _TransmitEndian = EndianType::little
+	>
+	void AsyncSizedSendBytes(
+		const _ContainerType& data,
+		AsyncSendCallback callback = AsyncSendCallback()
+	)
+	{
+		using _ValueType = typename _ContainerType::value_type;
+		static_assert(std::is_trivially_copyable<_ValueType>::value,
+			"Container value type must be trivially copyable");
+		static_assert(sizeof(_ValueType) == 1,
+			"Container value type must be byte-sized");
+
+		_SizeType sizeToSend = Internal::EndianConvert<
+			EndianType::native,
+			_TransmitEndian
+		>::Primitive(Internal::Obj::RealNumCast<_SizeType>(data.size()));
+
+		std::vector<uint8_t> bytes(sizeof(_SizeType) + data.size());
+		std::memcpy(bytes.data(), &sizeToSend, sizeof(_SizeType));
+		if (data.size() > 0)
+		{
+			std::memcpy(
+				bytes.data() + sizeof(_SizeType),
+				data.data(),
+				data.size()
+			);
+		}
+		AsyncSendRaw(std::move(bytes), std::move(callback));
+	}
+
 protected:
 
 
@@ -351,6 +650,25 @@ protected:
 	}
 
 
+	/**
+	 * @brief Send all bytes in the given segments, in order.
+	 *        The default implementation sends the segments one by one;
+	 *        implementations should override it with a gathered send.
+	 *        NOTE: this function will block until *ALL* data is sent,
+	 *        or an error occurs
+	 *
+	 * @param segments The segments to be sent
+	 * @param segCount The number of segments
+	 */
+	virtual void SendRawV(const ConstBytesView* segments, size_t segCount)
+	{
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			SendRawUntilComplete(segments[i].data(), segments[i].size());
+		}
+	}
+
+
 	/**
 	 * @brief The very basic interface to receive data with the given pointer
 	 *        to the memory buffer to store the received data and the size of
@@ -582,6 +900,15 @@ static size_t Send(StreamSocketBase& sock, const void* data, size_t size)
 	return sock.SendRaw(data, size);
 }
 
+static void SendV(
+	StreamSocketBase& sock,
+	const ConstBytesView* segments,
+	size_t segCount
+)
+{
+	sock.SendRawV(segments, segCount);
+}
+
 static size_t Recv(StreamSocketBase& sock, void* buf, size_t size)
 {
 	return sock.RecvRaw(buf, size);
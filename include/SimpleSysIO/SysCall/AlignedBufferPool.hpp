@@ -0,0 +1,349 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#if defined(SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM) || \
+	defined(SIMPLESYSIO_ENABLE_SYSCALL_NETWORKING)
+
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#	include <malloc.h>
+#endif // defined(_WIN32)
+
+#include "../BytesView.hpp"
+#include "../Exceptions.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+class AlignedBufferPool;
+
+
+/**
+ * @brief A buffer handed out by `AlignedBufferPool`; the memory is returned
+ *        to the pool, instead of being freed, when the buffer is destroyed.
+ *        NOTE: the content of the buffer is not initialized.
+ */
+class AlignedBuffer
+{
+public: // static members:
+
+	using value_type = uint8_t;
+
+	friend class AlignedBufferPool;
+
+public:
+
+	AlignedBuffer() noexcept :
+		m_pool(),
+		m_data(nullptr),
+		m_size(0)
+	{}
+
+
+	AlignedBuffer(AlignedBuffer&& other) noexcept :
+		m_pool(std::move(other.m_pool)),
+		m_data(other.m_data),
+		m_size(other.m_size)
+	{
+		other.m_data = nullptr;
+		other.m_size = 0;
+	}
+
+
+	AlignedBuffer(const AlignedBuffer&) = delete;
+
+
+	~AlignedBuffer()
+	{
+		Reset();
+	}
+
+
+	AlignedBuffer& operator=(AlignedBuffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+
+			m_pool = std::move(other.m_pool);
+			m_data = other.m_data;
+			m_size = other.m_size;
+
+			other.m_data = nullptr;
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+
+	AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+
+	value_type* data() const noexcept
+	{
+		return m_data;
+	}
+
+
+	size_t size() const noexcept
+	{
+		return m_size;
+	}
+
+
+	MutableBytesView GetView() const noexcept
+	{
+		return MutableBytesView(m_data, m_size);
+	}
+
+
+	/**
+	 * @brief Return the memory to the pool; the buffer will be empty
+	 *        afterwards
+	 */
+	inline void Reset() noexcept;
+
+
+private:
+
+	AlignedBuffer(
+		std::shared_ptr<AlignedBufferPool> pool,
+		value_type* data,
+		size_t size
+	) noexcept :
+		m_pool(std::move(pool)),
+		m_data(data),
+		m_size(size)
+	{}
+
+
+	std::shared_ptr<AlignedBufferPool> m_pool;
+	value_type* m_data;
+	size_t m_size;
+
+}; // class AlignedBuffer
+
+
+/**
+ * @brief A thread-safe pool of fixed-size buffers, whose addresses are
+ *        aligned to the given alignment, which is required by I/O operations
+ *        bypassing the OS cache (e.g., `O_DIRECT`); it is also used to
+ *        recycle socket receive buffers (see `TCPSocket::AsyncRecvPooled`).
+ *        Released buffers are kept in the pool for reuse, up to `maxCached`
+ *        buffers.
+ */
+class AlignedBufferPool :
+	public std::enable_shared_from_this<AlignedBufferPool>
+{
+public: // static members:
+
+	static constexpr size_t sk_defAlignment = 4096;
+	static constexpr size_t sk_defBufferSize = 1024 * 1024;
+	static constexpr size_t sk_defMaxCached = 16;
+
+	friend class AlignedBuffer;
+
+
+	/**
+	 * @brief Create a pool
+	 *
+	 * @param bufferSize The size of each buffer; it will be rounded up to a
+	 *                   multiple of the alignment
+	 * @param alignment  The alignment; must be a power of two, and a multiple
+	 *                   of `sizeof(void*)`
+	 * @param maxCached  The maximum number of released buffers to be kept
+	 * @return A shared pointer to the pool; buffers hold a reference to the
+	 *         pool, so they may outlive the returned pointer
+	 */
+	static std::shared_ptr<AlignedBufferPool> Create(
+		size_t bufferSize = sk_defBufferSize,
+		size_t alignment = sk_defAlignment,
+		size_t maxCached = sk_defMaxCached
+	)
+	{
+		if ((alignment == 0) ||
+			((alignment & (alignment - 1)) != 0) ||
+			((alignment % sizeof(void*)) != 0))
+		{
+			throw Exception("Invalid alignment for the aligned buffer pool");
+		}
+		if (bufferSize == 0)
+		{
+			throw Exception("Invalid buffer size for the aligned buffer pool");
+		}
+
+		bufferSize = ((bufferSize + alignment - 1) / alignment) * alignment;
+
+		return std::shared_ptr<AlignedBufferPool>(
+			new AlignedBufferPool(bufferSize, alignment, maxCached)
+		);
+	}
+
+
+	static void* AlignedAlloc(size_t size, size_t alignment)
+	{
+		void* ptr = nullptr;
+#if defined(_WIN32)
+		ptr = _aligned_malloc(size, alignment);
+#else
+		if (posix_memalign(&ptr, alignment, size) != 0)
+		{
+			ptr = nullptr;
+		}
+#endif // defined(_WIN32)
+		if (ptr == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return ptr;
+	}
+
+
+	static void AlignedFree(void* ptr) noexcept
+	{
+#if defined(_WIN32)
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif // defined(_WIN32)
+	}
+
+public:
+
+	~AlignedBufferPool()
+	{
+		for (auto ptr : m_freeList)
+		{
+			AlignedFree(ptr);
+		}
+	}
+
+
+	/**
+	 * @brief Get a buffer from the pool; a new one is allocated if there is
+	 *        no buffer available in the pool
+	 */
+	AlignedBuffer Acquire()
+	{
+		uint8_t* ptr = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_freeList.empty())
+			{
+				ptr = m_freeList.back();
+				m_freeList.pop_back();
+			}
+		}
+
+		if (ptr == nullptr)
+		{
+			ptr = static_cast<uint8_t*>(
+				AlignedAlloc(m_bufferSize, m_alignment)
+			);
+		}
+
+		return AlignedBuffer(shared_from_this(), ptr, m_bufferSize);
+	}
+
+
+	size_t GetBufferSize() const noexcept
+	{
+		return m_bufferSize;
+	}
+
+
+	size_t GetAlignment() const noexcept
+	{
+		return m_alignment;
+	}
+
+
+	size_t GetNumCached() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_freeList.size();
+	}
+
+
+private:
+
+	AlignedBufferPool(
+		size_t bufferSize,
+		size_t alignment,
+		size_t maxCached
+	) :
+		m_bufferSize(bufferSize),
+		m_alignment(alignment),
+		m_maxCached(maxCached),
+		m_mutex(),
+		m_freeList()
+	{
+		// so releasing a buffer never needs to allocate
+		m_freeList.reserve(m_maxCached);
+	}
+
+
+	void Release(uint8_t* ptr) noexcept
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_freeList.size() < m_maxCached)
+			{
+				m_freeList.push_back(ptr);
+				return;
+			}
+		}
+		AlignedFree(ptr);
+	}
+
+
+	size_t m_bufferSize;
+	size_t m_alignment;
+	size_t m_maxCached;
+	mutable std::mutex m_mutex;
+	std::vector<uint8_t*> m_freeList;
+
+}; // class AlignedBufferPool
+
+
+inline void AlignedBuffer::Reset() noexcept
+{
+	if (m_data != nullptr)
+	{
+		m_pool->Release(m_data);
+		m_data = nullptr;
+		m_size = 0;
+	}
+	m_pool.reset();
+}
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM ||
+       // SIMPLESYSIO_ENABLE_SYSCALL_NETWORKING
@@ -0,0 +1,330 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "IOUringEngine.hpp"
+
+
+#ifdef SIMPLESYSIO_SYSCALL_HAS_IO_URING
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../BinaryIOStreamBase.hpp"
+#include "../Internal/SimpleObjects.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief File descriptor based read-only binary stream, with asynchronous
+ *        operations driven by an `IOUringEngine`.
+ *        The synchronous interface of `RBinaryIOSBase` is still available.
+ *        NOTE: the stream must outlive its asynchronous operations.
+ */
+class AsyncRBinaryIOS :
+	public RBinaryIOSWrapper<SysCallInternal::FDOpenImpl>
+{
+public: // static members:
+
+	using ImplType = SysCallInternal::FDOpenImpl;
+	using Base = RBinaryIOSWrapper<ImplType>;
+	using AsyncFileCallback = IOUringEngine::AsyncFileCallback;
+
+public:
+
+	AsyncRBinaryIOS(
+		std::unique_ptr<ImplType> impl,
+		std::shared_ptr<IOUringEngine> engine
+	) :
+		Base(std::move(impl)),
+		m_engine(std::move(engine))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~AsyncRBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Read up to `size` bytes at `offset` asynchronously;
+	 *        the current position is neither used nor moved
+	 */
+	void AsyncRead(size_t offset, size_t size, AsyncFileCallback callback)
+	{
+		m_engine->AsyncRead(
+			GetImpl().GetFD(), offset, size, std::move(callback)
+		);
+	}
+
+
+	const std::shared_ptr<IOUringEngine>& GetEngine() const
+	{
+		return m_engine;
+	}
+
+
+private:
+
+	std::shared_ptr<IOUringEngine> m_engine;
+
+}; // class AsyncRBinaryIOS
+
+
+/**
+ * @brief File descriptor based write-only binary stream, with asynchronous
+ *        operations driven by an `IOUringEngine`.
+ *        NOTE: the stream must outlive its asynchronous operations.
+ */
+class AsyncWBinaryIOS :
+	public WBinaryIOSWrapper<SysCallInternal::FDOpenImpl>
+{
+public: // static members:
+
+	using ImplType = SysCallInternal::FDOpenImpl;
+	using Base = WBinaryIOSWrapper<ImplType>;
+	using AsyncFileCallback = IOUringEngine::AsyncFileCallback;
+
+public:
+
+	AsyncWBinaryIOS(
+		std::unique_ptr<ImplType> impl,
+		std::shared_ptr<IOUringEngine> engine
+	) :
+		Base(std::move(impl)),
+		m_engine(std::move(engine))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~AsyncWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Write all bytes in `data` at `offset` asynchronously;
+	 *        the current position is neither used nor moved.
+	 *        NOTE: if the file is opened in the append mode, the data is
+	 *        always appended to the end
+	 */
+	void AsyncWrite(
+		size_t offset,
+		std::vector<uint8_t> data,
+		AsyncFileCallback callback
+	)
+	{
+		m_engine->AsyncWrite(
+			GetImpl().GetFD(), offset, std::move(data), std::move(callback)
+		);
+	}
+
+
+	/**
+	 * @brief Flush the data of the file to the storage device
+	 *        asynchronously
+	 *
+	 * @param dataOnly Only flush the data, and the metadata needed to
+	 *                 retrieve the data (i.e., `fdatasync`)
+	 */
+	void AsyncFsync(bool dataOnly, AsyncFileCallback callback)
+	{
+		m_engine->AsyncFsync(GetImpl().GetFD(), dataOnly, std::move(callback));
+	}
+
+
+	const std::shared_ptr<IOUringEngine>& GetEngine() const
+	{
+		return m_engine;
+	}
+
+
+private:
+
+	std::shared_ptr<IOUringEngine> m_engine;
+
+}; // class AsyncWBinaryIOS
+
+
+/**
+ * @brief File descriptor based read-write binary stream, with asynchronous
+ *        operations driven by an `IOUringEngine`.
+ *        NOTE: the stream must outlive its asynchronous operations.
+ */
+class AsyncRWBinaryIOS :
+	public RWBinaryIOSWrapper<SysCallInternal::FDOpenImpl>
+{
+public: // static members:
+
+	using ImplType = SysCallInternal::FDOpenImpl;
+	using Base = RWBinaryIOSWrapper<ImplType>;
+	using AsyncFileCallback = IOUringEngine::AsyncFileCallback;
+
+public:
+
+	AsyncRWBinaryIOS(
+		std::unique_ptr<ImplType> impl,
+		std::shared_ptr<IOUringEngine> engine
+	) :
+		Base(std::move(impl)),
+		m_engine(std::move(engine))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~AsyncRWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	void AsyncRead(size_t offset, size_t size, AsyncFileCallback callback)
+	{
+		m_engine->AsyncRead(
+			GetImpl().GetFD(), offset, size, std::move(callback)
+		);
+	}
+
+
+	void AsyncWrite(
+		size_t offset,
+		std::vector<uint8_t> data,
+		AsyncFileCallback callback
+	)
+	{
+		m_engine->AsyncWrite(
+			GetImpl().GetFD(), offset, std::move(data), std::move(callback)
+		);
+	}
+
+
+	void AsyncFsync(bool dataOnly, AsyncFileCallback callback)
+	{
+		m_engine->AsyncFsync(GetImpl().GetFD(), dataOnly, std::move(callback));
+	}
+
+
+	const std::shared_ptr<IOUringEngine>& GetEngine() const
+	{
+		return m_engine;
+	}
+
+
+private:
+
+	std::shared_ptr<IOUringEngine> m_engine;
+
+}; // class AsyncRWBinaryIOS
+
+
+namespace SysCallInternal
+{
+
+template<typename _WrapperType>
+struct AsyncOpenerImpl
+{
+
+	using ImplType = FDOpenImpl;
+	using WrapperType = _WrapperType;
+	using RetType = std::unique_ptr<WrapperType>;
+
+protected:
+
+	static RetType OpenImpl(
+		const std::string& path,
+		const std::string& mode,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		if (engine == nullptr)
+		{
+			throw Exception("The async I/O engine is not given");
+		}
+
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl),
+				std::move(engine)
+			);
+	}
+
+}; // struct AsyncOpenerImpl
+
+} // namespace SysCallInternal
+
+
+struct AsyncRBinaryFile :
+	SysCallInternal::AsyncOpenerImpl<AsyncRBinaryIOS>
+{
+	static RetType Open(
+		const std::string& path,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		return OpenImpl(path, "rb", std::move(engine));
+	}
+}; // struct AsyncRBinaryFile
+
+
+struct AsyncWBinaryFile :
+	SysCallInternal::AsyncOpenerImpl<AsyncWBinaryIOS>
+{
+	static RetType Create(
+		const std::string& path,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		return OpenImpl(path, "wb", std::move(engine));
+	}
+
+	static RetType Append(
+		const std::string& path,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		return OpenImpl(path, "ab", std::move(engine));
+	}
+}; // struct AsyncWBinaryFile
+
+
+struct AsyncRWBinaryFile :
+	SysCallInternal::AsyncOpenerImpl<AsyncRWBinaryIOS>
+{
+	static RetType Create(
+		const std::string& path,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		return OpenImpl(path, "wb+", std::move(engine));
+	}
+
+	static RetType Append(
+		const std::string& path,
+		std::shared_ptr<IOUringEngine> engine
+	)
+	{
+		return OpenImpl(path, "ab+", std::move(engine));
+	}
+}; // struct AsyncRWBinaryFile
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_SYSCALL_HAS_IO_URING
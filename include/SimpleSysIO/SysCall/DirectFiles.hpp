@@ -0,0 +1,635 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#if defined(SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM) && !defined(_WIN32)
+
+
+#include <cerrno>
+#include <cstring>
+
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <SimpleObjects/RealNumCast.hpp>
+
+#include "../BinaryIOStreamBase.hpp"
+#include "../BytesView.hpp"
+#include "../Exceptions.hpp"
+#include "../Internal/SimpleObjects.hpp"
+#include "AlignedBufferPool.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+namespace SysCallInternal
+{
+
+/**
+ * @brief File implementation that bypasses the OS page cache
+ *        (`O_DIRECT` on Linux, `F_NOCACHE` on macOS).
+ *        Direct I/O requires the file offset, the transfer size and the
+ *        memory address to be aligned; this implementation handles
+ *        unaligned requests internally by going through aligned bounce
+ *        buffers taken from an `AlignedBufferPool`, while aligned requests
+ *        (e.g., into buffers from the same pool) go to the OS directly.
+ *        Writes that do not end on an aligned boundary are padded on the
+ *        disk, and the file is truncated back to its logical size on
+ *        `Flush()` and when the file is closed.
+ *        NOTE: the logical size is tracked by this object, so the file
+ *        should not be modified by others while it is opened.
+ */
+class DirectIOImpl
+{
+public: // static members:
+
+	static int DirectOpenS(const std::string& path, int flags)
+	{
+#if defined(O_DIRECT)
+		return FDOpenImpl::FDOpenS(path, flags | O_DIRECT);
+#else
+		int fd = FDOpenImpl::FDOpenS(path, flags);
+#	if defined(F_NOCACHE)
+		if (::fcntl(fd, F_NOCACHE, 1) != 0)
+		{
+			::close(fd);
+			throw Exception(
+				"I/O error while disabling the cache for the file at " + path
+			);
+		}
+#	endif // defined(F_NOCACHE)
+		return fd;
+#endif // defined(O_DIRECT)
+	}
+
+public:
+
+	DirectIOImpl(
+		const std::string& path,
+		const std::string& mode,
+		std::shared_ptr<AlignedBufferPool> pool
+	) :
+		DirectIOImpl(path, FDOpenImpl::ModeToFlags(mode), std::move(pool))
+	{}
+
+
+	~DirectIOImpl()
+	{
+		if (m_needsTruncate)
+		{
+			// nothing we can do if it fails in the destructor
+			int res = ::ftruncate(m_fd, static_cast<off_t>(m_fileSize));
+			(void)res;
+		}
+		::close(m_fd);
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		std::ptrdiff_t base = 0;
+		switch (whence)
+		{
+		case SeekWhence::Begin:
+			base = 0;
+			break;
+
+		case SeekWhence::Current:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_pos);
+			break;
+
+		case SeekWhence::End:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_fileSize);
+			break;
+
+		default:
+			throw Exception("Invalid SeekWhence value");
+		}
+
+		if (offset < -base)
+		{
+			throw Exception("Seeking to a position before the beginning");
+		}
+
+		m_pos = static_cast<size_t>(base + offset);
+	}
+
+
+	size_t Tell() const
+	{
+		return m_pos;
+	}
+
+
+	void Flush()
+	{
+		if (m_needsTruncate)
+		{
+			if (::ftruncate(m_fd, static_cast<off_t>(m_fileSize)) != 0)
+			{
+				throw Exception("I/O error while truncating the file");
+			}
+			m_needsTruncate = false;
+		}
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		size_t readSize = ReadAtRaw(m_pos, buffer, size);
+		m_pos += readSize;
+		return readSize;
+	}
+
+
+	void WriteBytesRaw(const void* buffer, size_t size)
+	{
+		if (m_isAppend)
+		{
+			m_pos = m_fileSize;
+		}
+		WriteAtRaw(m_pos, buffer, size);
+		m_pos += size;
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size) const
+	{
+		if (offset >= m_fileSize)
+		{
+			return 0;
+		}
+		const size_t reqSize = size;
+		size = Min(size, m_fileSize - offset);
+
+		uint8_t* dest = static_cast<uint8_t*>(buffer);
+
+		if (IsAligned(offset) && IsAligned(reqSize) && IsAligned(dest))
+		{
+			// the caller's buffer can hold the aligned size, so read into it
+			// directly
+			size_t res = PReadAligned(offset, dest, AlignUp(size), size);
+			return Min(res, size);
+		}
+
+		AlignedBuffer bounce = m_pool->Acquire();
+		const size_t reqEnd = AlignUp(offset + size);
+
+		size_t done = 0;
+		while (done < size)
+		{
+			size_t curr = offset + done;
+			size_t blockStart = AlignDown(curr);
+			size_t inBlockOffset = curr - blockStart;
+			size_t readLen = Min(bounce.size(), reqEnd - blockStart);
+
+			size_t res =
+				PReadAligned(blockStart, bounce.data(), readLen, readLen);
+			if (res <= inBlockOffset)
+			{
+				break;
+			}
+
+			size_t copyLen = Min(res - inBlockOffset, size - done);
+			std::memcpy(dest + done, bounce.data() + inBlockOffset, copyLen);
+			done += copyLen;
+
+			if (res < readLen)
+			{
+				// reached the end of the file
+				break;
+			}
+		}
+
+		return done;
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		const uint8_t* src = static_cast<const uint8_t*>(buffer);
+
+		if (IsAligned(offset) && IsAligned(size) && IsAligned(src))
+		{
+			PWriteAll(offset, src, size);
+			UpdateFileSize(offset + size, offset + size);
+			return;
+		}
+
+		AlignedBuffer bounce = m_pool->Acquire();
+		const size_t reqEnd = AlignUp(offset + size);
+
+		size_t done = 0;
+		while (done < size)
+		{
+			size_t curr = offset + done;
+			size_t blockStart = AlignDown(curr);
+			size_t inBlockOffset = curr - blockStart;
+			size_t chunkEnd = Min(reqEnd, blockStart + bounce.size());
+			size_t copyLen = Min(chunkEnd - curr, size - done);
+			size_t dataEnd = curr + copyLen;
+
+			// partial blocks at both ends of the chunk need to be filled
+			// with the existing data first
+			if (inBlockOffset > 0)
+			{
+				LoadBlock(blockStart, bounce.data());
+			}
+			if (dataEnd < chunkEnd)
+			{
+				size_t tailStart = AlignDown(dataEnd);
+				if ((tailStart != blockStart) || (inBlockOffset == 0))
+				{
+					LoadBlock(tailStart, bounce.data() + (tailStart - blockStart));
+				}
+			}
+
+			std::memcpy(bounce.data() + inBlockOffset, src + done, copyLen);
+			PWriteAll(blockStart, bounce.data(), chunkEnd - blockStart);
+
+			done += copyLen;
+			UpdateFileSize(dataEnd, chunkEnd);
+		}
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		size_t readSize = ReadAtVRaw(m_pos, segments, segCount);
+		m_pos += readSize;
+		return readSize;
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			WriteBytesRaw(segments[i].data(), segments[i].size());
+		}
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) const
+	{
+		// each segment is read separately, since the alignment requirement
+		// applies to each of them
+		size_t readSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			size_t segReadSize = ReadAtRaw(
+				offset + readSize,
+				segments[i].data(),
+				segments[i].size()
+			);
+			readSize += segReadSize;
+			if (segReadSize < segments[i].size())
+			{
+				break;
+			}
+		}
+		return readSize;
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			WriteAtRaw(offset, segments[i].data(), segments[i].size());
+			offset += segments[i].size();
+		}
+	}
+
+
+	const std::shared_ptr<AlignedBufferPool>& GetBufferPool() const
+	{
+		return m_pool;
+	}
+
+
+	FileStat GetStat() const
+	{
+		FileStat res = FDCalls::Stat(m_fd);
+		// the file may still be padded on the disk
+		res.m_size = m_fileSize;
+		return res;
+	}
+
+
+	int GetNativeFD() const
+	{
+		// the logical size is tracked here, and the file may be padded on
+		// the disk, so the descriptor cannot be used by others directly
+		return -1;
+	}
+
+
+private:
+
+	DirectIOImpl(
+		const std::string& path,
+		int flags,
+		std::shared_ptr<AlignedBufferPool> pool
+	) :
+		// partial blocks are read back before being written, so the file is
+		// always opened for both reading and writing when it is writable;
+		// the append mode is emulated, since `O_APPEND` does not work with
+		// aligned writes
+		m_fd(
+			DirectOpenS(
+				path,
+				((flags & O_WRONLY) != 0) ?
+					((flags & ~(O_WRONLY | O_APPEND)) | O_RDWR) :
+					(flags & ~O_APPEND)
+			)
+		),
+		m_pool(
+			pool == nullptr ? AlignedBufferPool::Create() : std::move(pool)
+		),
+		m_alignment(m_pool->GetAlignment()),
+		m_pos(0),
+		m_fileSize(0),
+		m_isAppend((flags & O_APPEND) != 0),
+		m_needsTruncate(false)
+	{
+		struct stat fileStat;
+		if (::fstat(m_fd, &fileStat) != 0)
+		{
+			::close(m_fd);
+			throw Exception("I/O error while reading the file status");
+		}
+		m_fileSize = static_cast<size_t>(fileStat.st_size);
+
+		if (m_isAppend)
+		{
+			m_pos = m_fileSize;
+		}
+	}
+
+
+	static size_t Min(size_t a, size_t b)
+	{
+		return a < b ? a : b;
+	}
+
+
+	bool IsAligned(size_t value) const
+	{
+		return (value & (m_alignment - 1)) == 0;
+	}
+
+
+	bool IsAligned(const void* ptr) const
+	{
+		return IsAligned(reinterpret_cast<uintptr_t>(ptr));
+	}
+
+
+	size_t AlignDown(size_t value) const
+	{
+		return value & ~(m_alignment - 1);
+	}
+
+
+	size_t AlignUp(size_t value) const
+	{
+		return AlignDown(value + m_alignment - 1);
+	}
+
+
+	/**
+	 * @brief Read into an aligned buffer of `size` (aligned) bytes, until at
+	 *        least `wanted` bytes are read; a short read is continued only if
+	 *        it ends at an aligned position (e.g., Linux caps a single read
+	 *        at 0x7ffff000 bytes), since the next request would be unaligned
+	 *        otherwise, and such a read only happens at the end of the file
+	 */
+	size_t PReadAligned(
+		size_t offset,
+		uint8_t* buffer,
+		size_t size,
+		size_t wanted
+	) const
+	{
+		size_t done = 0;
+		while (done < wanted)
+		{
+			size_t res = PReadOnce(offset + done, buffer + done, size - done);
+			done += res;
+			if ((res == 0) || !IsAligned(res))
+			{
+				break;
+			}
+		}
+		return done;
+	}
+
+
+	/**
+	 * @brief Read with one `pread` call (retried only on interruption)
+	 */
+	size_t PReadOnce(size_t offset, void* buffer, size_t size) const
+	{
+		while (true)
+		{
+			ssize_t res = ::pread(
+				m_fd,
+				buffer,
+				size,
+				Internal::Obj::RealNumCast<off_t>(offset)
+			);
+			if (res >= 0)
+			{
+				return static_cast<size_t>(res);
+			}
+			else if (errno != EINTR)
+			{
+				throw Exception("I/O error while reading the file");
+			}
+		}
+	}
+
+
+	void PWriteAll(size_t offset, const void* buffer, size_t size)
+	{
+		while (true)
+		{
+			ssize_t res = ::pwrite(
+				m_fd,
+				buffer,
+				size,
+				Internal::Obj::RealNumCast<off_t>(offset)
+			);
+			if (res >= 0)
+			{
+				if (static_cast<size_t>(res) != size)
+				{
+					throw Exception("I/O error while writing the file");
+				}
+				return;
+			}
+			else if (errno != EINTR)
+			{
+				throw Exception("I/O error while writing the file");
+			}
+		}
+	}
+
+
+	/**
+	 * @brief Load one block of existing data into the given buffer;
+	 *        anything beyond the end of the file is filled with zeros
+	 */
+	void LoadBlock(size_t blockStart, uint8_t* dest) const
+	{
+		size_t res = 0;
+		if (blockStart < m_fileSize)
+		{
+			res = PReadOnce(blockStart, dest, m_alignment);
+		}
+		std::memset(dest + res, 0, m_alignment - res);
+	}
+
+
+	void UpdateFileSize(size_t dataEnd, size_t writtenEnd)
+	{
+		if (dataEnd > m_fileSize)
+		{
+			m_fileSize = dataEnd;
+		}
+		if (writtenEnd > m_fileSize)
+		{
+			m_needsTruncate = true;
+		}
+	}
+
+
+	int m_fd;
+	std::shared_ptr<AlignedBufferPool> m_pool;
+	size_t m_alignment;
+	size_t m_pos;
+	size_t m_fileSize;
+	bool m_isAppend;
+	bool m_needsTruncate;
+
+}; // class DirectIOImpl
+
+
+template<
+	template<typename> class _WrapperType,
+	typename _BaseType
+>
+struct DirectOpenerImpl
+{
+
+	using ImplType = DirectIOImpl;
+	using WrapperType = _WrapperType<ImplType>;
+	using RetType = std::unique_ptr<_BaseType>;
+
+protected:
+
+	static RetType OpenImpl(
+		const std::string& path,
+		const std::string& mode,
+		std::shared_ptr<AlignedBufferPool> pool
+	)
+	{
+		auto impl = Internal::Obj::Internal::make_unique<ImplType>(
+			path,
+			mode,
+			std::move(pool)
+		);
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+
+}; // struct DirectOpenerImpl
+
+} // namespace SysCallInternal
+
+
+/**
+ * @brief Open files for reading, bypassing the OS page cache.
+ *        Bounce buffers are taken from the given pool, whose alignment
+ *        determines the alignment used for the direct I/O; if no pool is
+ *        given, a default one (1 MiB buffers, 4 KiB alignment) is created.
+ *        Reading into buffers acquired from the same pool, at aligned
+ *        offsets, avoids the extra copy.
+ */
+struct DirectRBinaryFile :
+	SysCallInternal::DirectOpenerImpl<RBinaryIOSWrapper, RBinaryIOSBase>
+{
+	static RetType Open(
+		const std::string& path,
+		std::shared_ptr<AlignedBufferPool> pool = nullptr
+	)
+	{
+		return OpenImpl(path, "rb", std::move(pool));
+	}
+}; // struct DirectRBinaryFile
+
+
+/**
+ * @brief Open files for writing, bypassing the OS page cache.
+ *        See `DirectRBinaryFile` for the use of the buffer pool.
+ */
+struct DirectWBinaryFile :
+	SysCallInternal::DirectOpenerImpl<WBinaryIOSWrapper, WBinaryIOSBase>
+{
+	static RetType Create(
+		const std::string& path,
+		std::shared_ptr<AlignedBufferPool> pool = nullptr
+	)
+	{
+		return OpenImpl(path, "wb", std::move(pool));
+	}
+
+	static RetType Append(
+		const std::string& path,
+		std::shared_ptr<AlignedBufferPool> pool = nullptr
+	)
+	{
+		return OpenImpl(path, "ab", std::move(pool));
+	}
+}; // struct DirectWBinaryFile
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM && !_WIN32
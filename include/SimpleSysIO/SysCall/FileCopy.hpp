@@ -0,0 +1,265 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#ifdef SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
+
+
+#include <vector>
+
+#if defined(__linux__)
+#	include <cerrno>
+
+#	include <linux/fs.h>
+#	include <sys/ioctl.h>
+#	include <unistd.h>
+#endif // defined(__linux__)
+
+#include "../BinaryIOStreamBase.hpp"
+#include "../Exceptions.hpp"
+#include "../Internal/SimpleObjects.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+struct FileCopy
+{
+
+	static constexpr size_t sk_copyBufferSize = 1024 * 1024;
+
+
+	/**
+	 * @brief Copy `size` bytes starting from `srcOffset` in `src`, to
+	 *        `dstOffset` in `dst`, without moving the current position of
+	 *        either stream.
+	 *        When both streams are backed by file descriptors, the copy is
+	 *        done inside the kernel: the range is cloned (reflink) if the
+	 *        file system supports it, or copied with `copy_file_range`
+	 *        otherwise; data never crosses the user space. In all other
+	 *        cases (e.g., other OSes, or files on different file systems
+	 *        with an old kernel), it falls back to a loop with a large
+	 *        buffer.
+	 *        NOTE: `dst` is flushed first; pending writes to `src` must be
+	 *        flushed by the caller, if it is also writable.
+	 *        NOTE: if `dst` is opened in the append mode, the data is
+	 *        appended to the end.
+	 *
+	 * @return The number of bytes copied; it may be less than `size` if
+	 *         the end of `src` is reached
+	 */
+	static size_t CopyRange(
+		RBinaryIOSBase& src,
+		size_t srcOffset,
+		WBinaryIOSBase& dst,
+		size_t dstOffset,
+		size_t size
+	)
+	{
+		dst.Flush();
+
+		size_t srcSize = src.GetFileSize();
+		if (srcOffset >= srcSize)
+		{
+			return 0;
+		}
+		if (size > srcSize - srcOffset)
+		{
+			size = srcSize - srcOffset;
+		}
+		if (size == 0)
+		{
+			// a zero length means "to the end" for `FICLONE_RANGE`
+			return 0;
+		}
+
+		size_t copied = 0;
+
+#if defined(__linux__)
+		int srcFD = src.GetNativeFD();
+		int dstFD = dst.GetNativeFD();
+		if ((srcFD >= 0) && (dstFD >= 0))
+		{
+			if (TryCloneRange(srcFD, srcOffset, dstFD, dstOffset, size))
+			{
+				return size;
+			}
+
+			copied = KernelCopyRange(
+				srcFD, srcOffset, dstFD, dstOffset, size
+			);
+		}
+#endif // defined(__linux__)
+
+		return copied + BufferedCopyRange(
+			src,
+			srcOffset + copied,
+			dst,
+			dstOffset + copied,
+			size - copied
+		);
+	}
+
+
+	/**
+	 * @brief Copy the entire content of `src` to the beginning of `dst`
+	 *
+	 * @return The number of bytes copied
+	 */
+	static size_t CopyAll(RBinaryIOSBase& src, WBinaryIOSBase& dst)
+	{
+		return CopyRange(src, 0, dst, 0, src.GetFileSize());
+	}
+
+
+private:
+
+#if defined(__linux__)
+	static bool TryCloneRange(
+		int srcFD,
+		size_t srcOffset,
+		int dstFD,
+		size_t dstOffset,
+		size_t size
+	)
+	{
+#	ifdef FICLONE_RANGE
+		// the range has to be aligned to the block size of the file system,
+		// unless it ends at the end of the source; the kernel checks it
+		struct file_clone_range range;
+		range.src_fd = srcFD;
+		range.src_offset = static_cast<uint64_t>(srcOffset);
+		range.src_length = static_cast<uint64_t>(size);
+		range.dest_offset = static_cast<uint64_t>(dstOffset);
+
+		return ::ioctl(dstFD, FICLONE_RANGE, &range) == 0;
+#	else
+		(void)srcFD;
+		(void)srcOffset;
+		(void)dstFD;
+		(void)dstOffset;
+		(void)size;
+		return false;
+#	endif // FICLONE_RANGE
+	}
+
+
+	/**
+	 * @return The number of bytes copied; the rest should be copied in
+	 *         the user space, if it is less than `size`
+	 */
+	static size_t KernelCopyRange(
+		int srcFD,
+		size_t srcOffset,
+		int dstFD,
+		size_t dstOffset,
+		size_t size
+	)
+	{
+		loff_t srcOff = Internal::Obj::RealNumCast<loff_t>(srcOffset);
+		loff_t dstOff = Internal::Obj::RealNumCast<loff_t>(dstOffset);
+
+		size_t copied = 0;
+		while (copied < size)
+		{
+			ssize_t res = ::copy_file_range(
+				srcFD, &srcOff, dstFD, &dstOff, size - copied, 0
+			);
+			if (res < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				if ((errno == EXDEV) ||
+					(errno == EINVAL) ||
+					(errno == ENOSYS) ||
+					(errno == EOPNOTSUPP) ||
+					(errno == EBADF))
+				{
+					// not supported between these two files
+					break;
+				}
+				throw Exception("I/O error while copying the file");
+			}
+			if (res == 0)
+			{
+				// end of the source
+				break;
+			}
+			copied += static_cast<size_t>(res);
+		}
+		return copied;
+	}
+#endif // defined(__linux__)
+
+
+	static size_t BufferedCopyRange(
+		RBinaryIOSBase& src,
+		size_t srcOffset,
+		WBinaryIOSBase& dst,
+		size_t dstOffset,
+		size_t size
+	)
+	{
+		if (size == 0)
+		{
+			return 0;
+		}
+
+		std::vector<uint8_t> buffer(
+			size < sk_copyBufferSize ? size : sk_copyBufferSize
+		);
+
+		size_t copied = 0;
+		while (copied < size)
+		{
+			size_t chunkSize = size - copied;
+			if (chunkSize > buffer.size())
+			{
+				chunkSize = buffer.size();
+			}
+
+			size_t readSize = Internal::BinaryIOSRaw::ReadAt(
+				src,
+				srcOffset + copied,
+				buffer.data(),
+				chunkSize
+			);
+			if (readSize == 0)
+			{
+				break;
+			}
+
+			Internal::BinaryIOSRaw::WriteAt(
+				dst,
+				dstOffset + copied,
+				buffer.data(),
+				readSize
+			);
+			copied += readSize;
+		}
+		return copied;
+	}
+
+}; // struct FileCopy
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
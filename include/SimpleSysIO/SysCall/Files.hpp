@@ -14,9 +14,26 @@
 
 #include <cstdio>
 
+#include <chrono>
 #include <memory>
 #include <string>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#	include <mutex>
+#else
+#	include <cerrno>
+#	include <climits>
+
+#	include <vector>
+
+#	include <fcntl.h>
+#	include <sys/uio.h>
+#	include <unistd.h>
+#endif // !defined(_WIN32)
+
 #include <SimpleObjects/RealNumCast.hpp>
 
 #include "../Exceptions.hpp"
@@ -24,57 +41,1292 @@
 #include "../BinaryIOStreamBase.hpp"
 
 
-#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
-namespace SimpleSysIO
-#else
-namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
-#endif
-{
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief Hints about how a file is going to be read, so the OS can tune its
+ *        caching and readahead for it.
+ *        NOTE: these are only hints; they are ignored where not supported
+ *        (e.g., on Windows).
+ */
+enum class AccessHint
+{
+	// no particular pattern; the default behavior of the OS
+	Normal,
+	// read from the beginning to the end; the kernel readahead is enlarged
+	Sequential,
+	// read at random positions; the kernel readahead is disabled, so
+	// point lookups do not waste bandwidth on data they never use
+	Random,
+	// the entire file will be needed soon; loading it into the cache starts
+	// right away
+	WillNeed,
+	// the data is read only once; pages behind the read position are
+	// dropped from the cache as the stream advances
+	DontNeed,
+}; // enum class AccessHint
+
+namespace SysCallInternal
+{
+
+#if !defined(_WIN32)
+
+/**
+ * @brief Wrappers of POSIX read/write calls that keep going until the
+ *        whole buffer is transferred, retrying on interruptions, plus
+ *        `fstat`
+ */
+struct FDCalls
+{
+	static size_t Read(int fd, void* buffer, size_t size)
+	{
+		return TransferLoop(
+			size,
+			false,
+			[fd, buffer](size_t done, size_t remain) -> ssize_t
+			{
+				return ::read(
+					fd, static_cast<uint8_t*>(buffer) + done, remain
+				);
+			}
+		);
+	}
+
+
+	static size_t Write(int fd, const void* buffer, size_t size)
+	{
+		return TransferLoop(
+			size,
+			true,
+			[fd, buffer](size_t done, size_t remain) -> ssize_t
+			{
+				return ::write(
+					fd, static_cast<const uint8_t*>(buffer) + done, remain
+				);
+			}
+		);
+	}
+
+
+	static size_t PRead(int fd, size_t offset, void* buffer, size_t size)
+	{
+		return TransferLoop(
+			size,
+			false,
+			[fd, offset, buffer](size_t done, size_t remain) -> ssize_t
+			{
+				return ::pread(
+					fd,
+					static_cast<uint8_t*>(buffer) + done,
+					remain,
+					Internal::Obj::RealNumCast<off_t>(offset + done)
+				);
+			}
+		);
+	}
+
+
+	static size_t PWrite(
+		int fd,
+		size_t offset,
+		const void* buffer,
+		size_t size
+	)
+	{
+		return TransferLoop(
+			size,
+			true,
+			[fd, offset, buffer](size_t done, size_t remain) -> ssize_t
+			{
+				return ::pwrite(
+					fd,
+					static_cast<const uint8_t*>(buffer) + done,
+					remain,
+					Internal::Obj::RealNumCast<off_t>(offset + done)
+				);
+			}
+		);
+	}
+
+
+	static size_t ReadV(
+		int fd,
+		const MutableBytesView* segments,
+		size_t segCount
+	)
+	{
+		return TransferVLoop(
+			segments,
+			segCount,
+			false,
+			[fd](size_t, const struct iovec* iov, int iovCount) -> ssize_t
+			{
+				return ::readv(fd, iov, iovCount);
+			}
+		);
+	}
+
+
+	static size_t WriteV(
+		int fd,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		return TransferVLoop(
+			segments,
+			segCount,
+			true,
+			[fd](size_t, const struct iovec* iov, int iovCount) -> ssize_t
+			{
+				return ::writev(fd, iov, iovCount);
+			}
+		);
+	}
+
+
+	static size_t PReadV(
+		int fd,
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	)
+	{
+		return TransferVLoop(
+			segments,
+			segCount,
+			false,
+			[fd, offset](
+				size_t done,
+				const struct iovec* iov,
+				int iovCount
+			) -> ssize_t
+			{
+				return ::preadv(
+					fd,
+					iov,
+					iovCount,
+					Internal::Obj::RealNumCast<off_t>(offset + done)
+				);
+			}
+		);
+	}
+
+
+	static size_t PWriteV(
+		int fd,
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		return TransferVLoop(
+			segments,
+			segCount,
+			true,
+			[fd, offset](
+				size_t done,
+				const struct iovec* iov,
+				int iovCount
+			) -> ssize_t
+			{
+				return ::pwritev(
+					fd,
+					iov,
+					iovCount,
+					Internal::Obj::RealNumCast<off_t>(offset + done)
+				);
+			}
+		);
+	}
+
+
+
+	/**
+	 * @brief Reserve disk space for `size` bytes from the beginning of the
+	 *        file, without changing the file size, so the file can be
+	 *        written in contiguous extents
+	 *
+	 * @return true if the space is reserved; false if it is not supported
+	 *         (it is only an optimization, so failures are not errors)
+	 */
+	static bool Preallocate(int fd, size_t size)
+	{
+		if (size == 0)
+		{
+			return false;
+		}
+
+		off_t cSize = Internal::Obj::RealNumCast<off_t>(size);
+
+#if defined(__linux__)
+		int res = 0;
+		do
+		{
+			res = ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, cSize);
+		} while ((res != 0) && (errno == EINTR));
+		return res == 0;
+#elif defined(__APPLE__)
+		fstore_t store;
+		store.fst_flags = F_ALLOCATECONTIG;
+		store.fst_posmode = F_PEOFPOSMODE;
+		store.fst_offset = 0;
+		store.fst_length = cSize;
+		store.fst_bytesalloc = 0;
+		if (::fcntl(fd, F_PREALLOCATE, &store) != -1)
+		{
+			return true;
+		}
+		// contiguous space is not available; take any
+		store.fst_flags = F_ALLOCATEALL;
+		return ::fcntl(fd, F_PREALLOCATE, &store) != -1;
+#else
+		(void)fd;
+		(void)cSize;
+		return false;
+#endif // defined(__linux__)
+	}
+
+
+	/**
+	 * @brief Release the space reserved beyond the end of the file, by
+	 *        truncating the file to its current size; failures are ignored
+	 */
+	static void ReleasePreallocated(int fd) noexcept
+	{
+		struct stat fileStat;
+		if (::fstat(fd, &fileStat) == 0)
+		{
+			int res = 0;
+			do
+			{
+				res = ::ftruncate(fd, fileStat.st_size);
+			} while ((res != 0) && (errno == EINTR));
+		}
+	}
+
+
+	/**
+	 * @brief Get the metadata of the file with one `fstat` call
+	 */
+	static FileStat Stat(int fd)
+	{
+		struct stat fileStat;
+		if (::fstat(fd, &fileStat) != 0)
+		{
+			throw Exception("I/O error while reading the file status");
+		}
+
+#if defined(__APPLE__)
+		const struct timespec& mtime = fileStat.st_mtimespec;
+#else
+		const struct timespec& mtime = fileStat.st_mtim;
+#endif // defined(__APPLE__)
+
+		FileStat res;
+		res.m_size = Internal::Obj::RealNumCast<size_t>(fileStat.st_size);
+		res.m_blockSize =
+			Internal::Obj::RealNumCast<size_t>(fileStat.st_blksize);
+		res.m_modifiedTime = std::chrono::system_clock::time_point(
+			std::chrono::duration_cast<std::chrono::system_clock::duration>(
+				std::chrono::seconds(mtime.tv_sec) +
+				std::chrono::nanoseconds(mtime.tv_nsec)
+			)
+		);
+		return res;
+	}
+
+
+private:
+
+#ifdef IOV_MAX
+	static constexpr size_t sk_maxIOVCount = IOV_MAX;
+#else
+	static constexpr size_t sk_maxIOVCount = 16;
+#endif // IOV_MAX
+
+
+	template<typename _CallType>
+	static size_t TransferLoop(size_t size, bool isWrite, _CallType call)
+	{
+		size_t done = 0;
+		while (done < size)
+		{
+			ssize_t res = call(done, size - done);
+			if (res < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				throw Exception(
+					isWrite ?
+						"I/O error while writing the file" :
+						"I/O error while reading the file"
+				);
+			}
+			else if (res == 0)
+			{
+				if (isWrite)
+				{
+					throw Exception("I/O error while writing the file");
+				}
+				// reached the end of the file
+				break;
+			}
+			done += static_cast<size_t>(res);
+		}
+
+		return done;
+	}
+
+
+	/**
+	 * @brief Same as `TransferLoop`, but for a list of segments; the
+	 *        segments are handed to the OS as `iovec` arrays, and the loop
+	 *        resumes from the middle of a segment after a partial transfer
+	 */
+	template<typename _ViewType, typename _CallType>
+	static size_t TransferVLoop(
+		const _ViewType* segments,
+		size_t segCount,
+		bool isWrite,
+		_CallType call
+	)
+	{
+		// at most `sk_maxIOVCount` entries are handed over per call, so they
+		// fit on the stack, and no allocation is needed per transfer
+		struct iovec iovs[sk_maxIOVCount];
+		size_t iovCount = 0;
+
+		size_t done = 0;
+		size_t segIdx = 0;
+		size_t segOffset = 0;
+		while (true)
+		{
+			// skip segments that have been completed, or are empty
+			while (
+				(segIdx < segCount) &&
+				(segOffset >= segments[segIdx].size())
+			)
+			{
+				++segIdx;
+				segOffset = 0;
+			}
+			if (segIdx >= segCount)
+			{
+				break;
+			}
+
+			iovCount = 0;
+			for (
+				size_t i = segIdx;
+				(i < segCount) && (iovCount < sk_maxIOVCount);
+				++i
+			)
+			{
+				size_t skip = (i == segIdx) ? segOffset : 0;
+				iovs[iovCount].iov_base = const_cast<uint8_t*>(
+					segments[i].data() + skip
+				);
+				iovs[iovCount].iov_len = segments[i].size() - skip;
+				++iovCount;
+			}
+
+			ssize_t res = call(done, iovs, static_cast<int>(iovCount));
+			if (res < 0)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				throw Exception(
+					isWrite ?
+						"I/O error while writing the file" :
+						"I/O error while reading the file"
+				);
+			}
+			else if (res == 0)
+			{
+				if (isWrite)
+				{
+					throw Exception("I/O error while writing the file");
+				}
+				// reached the end of the file
+				break;
+			}
+
+			size_t advance = static_cast<size_t>(res);
+			done += advance;
+			while (
+				(segIdx < segCount) &&
+				(advance >= (segments[segIdx].size() - segOffset))
+			)
+			{
+				advance -= (segments[segIdx].size() - segOffset);
+				++segIdx;
+				segOffset = 0;
+			}
+			segOffset += advance;
+		}
+
+		return done;
+	}
+
+}; // struct FDCalls
+
+
+/**
+ * @brief Applies an `AccessHint` to a file descriptor, and maintains an
+ *        optional readahead window, which asks the kernel to start loading
+ *        the next `readaheadSize` bytes in the background, while the caller
+ *        is still processing the data read earlier.
+ */
+class FileAdvisor
+{
+public: // static members:
+
+	/**
+	 * @brief Advise the kernel about the access pattern of the given range
+	 *
+	 * @param len The length of the range; zero means till the end of file
+	 */
+	static void AdviseRange(int fd, size_t offset, size_t len, AccessHint hint)
+	{
+#if defined(__APPLE__)
+		// there is no `posix_fadvise` on macOS
+		switch (hint)
+		{
+		case AccessHint::Sequential:
+		case AccessHint::Normal:
+			::fcntl(fd, F_RDAHEAD, 1);
+			break;
+
+		case AccessHint::Random:
+			::fcntl(fd, F_RDAHEAD, 0);
+			break;
+
+		case AccessHint::WillNeed:
+			if (len > 0)
+			{
+				struct radvisory advice;
+				advice.ra_offset = Internal::Obj::RealNumCast<off_t>(offset);
+				advice.ra_count = (len > INT_MAX) ?
+					INT_MAX : static_cast<int>(len);
+				::fcntl(fd, F_RDADVISE, &advice);
+			}
+			break;
+
+		case AccessHint::DontNeed:
+		default:
+			break;
+		}
+#else
+		int advice = POSIX_FADV_NORMAL;
+		switch (hint)
+		{
+		case AccessHint::Sequential:
+			advice = POSIX_FADV_SEQUENTIAL;
+			break;
+
+		case AccessHint::Random:
+			advice = POSIX_FADV_RANDOM;
+			break;
+
+		case AccessHint::WillNeed:
+			advice = POSIX_FADV_WILLNEED;
+			break;
+
+		case AccessHint::DontNeed:
+			advice = POSIX_FADV_DONTNEED;
+			break;
+
+		case AccessHint::Normal:
+		default:
+			break;
+		}
+
+		// failures are ignored, since it is only a hint
+		::posix_fadvise(
+			fd,
+			Internal::Obj::RealNumCast<off_t>(offset),
+			Internal::Obj::RealNumCast<off_t>(len),
+			advice
+		);
+#endif // defined(__APPLE__)
+	}
+
+public:
+
+	FileAdvisor() :
+		m_hint(AccessHint::Normal),
+		m_readaheadSize(0),
+		m_pos(0),
+		m_prefetchedEnd(0),
+		m_releasedEnd(0)
+	{}
+
+
+	/**
+	 * @brief Apply the hint to the whole file, and set up the readahead window
+	 *
+	 * @param pos           The current read position
+	 * @param readaheadSize The size of the readahead window; zero to disable
+	 */
+	void Apply(int fd, size_t pos, AccessHint hint, size_t readaheadSize)
+	{
+		m_hint = hint;
+		m_readaheadSize = readaheadSize;
+		m_pos = pos;
+		m_prefetchedEnd = pos;
+		m_releasedEnd = 0;
+
+		if (hint != AccessHint::DontNeed)
+		{
+			AdviseRange(fd, 0, 0, hint);
+		}
+
+		Update(fd);
+	}
+
+
+	/**
+	 * @brief Whether `OnRead` and `OnSeek` need to be called after reads
+	 *        and seeks
+	 */
+	bool IsTracking() const
+	{
+		return (m_readaheadSize > 0) || (m_hint == AccessHint::DontNeed);
+	}
+
+
+	/**
+	 * @brief Update the readahead window (and release consumed pages, if
+	 *        asked to) after `readSize` bytes are read; the read position is
+	 *        tracked here, so it does not cost a system call to tell
+	 */
+	void OnRead(int fd, size_t readSize)
+	{
+		m_pos += readSize;
+		Update(fd);
+	}
+
+
+	/**
+	 * @brief Reset the tracked read position after a seek; the window is
+	 *        updated by the next read
+	 */
+	void OnSeek(size_t pos)
+	{
+		m_pos = pos;
+	}
+
+
+private:
+
+	// pages consumed are released in batches of this size, to avoid one
+	// extra system call per read
+	static constexpr size_t sk_releaseStep = 1024 * 1024;
+
+
+	void Update(int fd)
+	{
+		const size_t pos = m_pos;
+
+		if (m_readaheadSize > 0)
+		{
+			if ((pos < m_prefetchedEnd) &&
+				(m_prefetchedEnd - pos > m_readaheadSize))
+			{
+				// seeked backward; restart the window from here
+				m_prefetchedEnd = pos;
+			}
+
+			// the next window is requested once half of the current one
+			// has been consumed, so there is always data loading ahead
+			if (pos + (m_readaheadSize / 2) >= m_prefetchedEnd)
+			{
+				size_t begin = (pos > m_prefetchedEnd) ? pos : m_prefetchedEnd;
+				size_t end = pos + m_readaheadSize;
+				AdviseRange(fd, begin, end - begin, AccessHint::WillNeed);
+				m_prefetchedEnd = end;
+			}
+		}
+
+		if ((m_hint == AccessHint::DontNeed) &&
+			(pos >= m_releasedEnd + sk_releaseStep))
+		{
+			AdviseRange(
+				fd,
+				m_releasedEnd,
+				pos - m_releasedEnd,
+				AccessHint::DontNeed
+			);
+			m_releasedEnd = pos;
+		}
+	}
+
+
+	AccessHint m_hint;
+	size_t m_readaheadSize;
+	size_t m_pos;
+	size_t m_prefetchedEnd;
+	size_t m_releasedEnd;
+
+}; // class FileAdvisor
+
+#endif // !defined(_WIN32)
+
+class COpenImpl
+{
+public: // static members:
+
+	// `long` used by `fseek` and `ftell` is only 32-bit on some ABIs,
+	// so the 64-bit variants are used instead
+#if defined(_WIN32)
+	using _COffsetType = __int64;
+
+	static int CSeek(std::FILE* file, _COffsetType offset, int origin)
+	{
+		return _fseeki64(file, offset, origin);
+	}
+
+	static _COffsetType CTell(std::FILE* file)
+	{
+		return _ftelli64(file);
+	}
+#else
+	using _COffsetType = off_t;
+
+	static int CSeek(std::FILE* file, _COffsetType offset, int origin)
+	{
+		return ::fseeko(file, offset, origin);
+	}
+
+	static _COffsetType CTell(std::FILE* file)
+	{
+		return ::ftello(file);
+	}
+#endif // defined(_WIN32)
+
+	static std::FILE* COpenS(
+		const std::string& path,
+		const std::string& mode
+	)
+	{
+		std::FILE* file = nullptr;
+#if defined(_WIN32)
+		auto err = fopen_s(&file, path.c_str(), mode.c_str());
+		if (err != 0)
+		{
+			throw Exception("I/O error while opening the file at " + path);
+		}
+#else
+		file = std::fopen(path.c_str(), mode.c_str());
+		if (file == nullptr)
+		{
+			throw Exception("I/O error while opening the file at " + path);
+		}
+#endif // defined(_WIN32)
+		return file;
+	}
+
+public:
+
+	COpenImpl(const std::string& path, const std::string& mode) :
+		COpenImpl(
+			COpenS(path, mode),
+			(mode.find_first_of("wa+") != std::string::npos)
+		)
+	{}
+
+
+	~COpenImpl()
+	{
+		if (m_filePtr != nullptr)
+		{
+#if !defined(_WIN32)
+			if (m_isPreallocated)
+			{
+				std::fflush(m_filePtr);
+				FDCalls::ReleasePreallocated(::fileno(m_filePtr));
+			}
+#endif // !defined(_WIN32)
+			std::fclose(m_filePtr);
+		}
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		ThrowIfFilePtrIsNull();
+
+		_COffsetType cOffset =
+			Internal::Obj::RealNumCast<_COffsetType>(offset);
+
+		switch (whence)
+		{
+		case SeekWhence::Begin:
+			CSeek(m_filePtr, cOffset, SEEK_SET);
+			break;
+
+		case SeekWhence::Current:
+			CSeek(m_filePtr, cOffset, SEEK_CUR);
+			break;
+
+		case SeekWhence::End:
+			CSeek(m_filePtr, cOffset, SEEK_END);
+			break;
+
+		default:
+			throw Exception("Invalid SeekWhence value");
+		}
+
+#if !defined(_WIN32)
+		if (m_advisor.IsTracking())
+		{
+			m_advisor.OnSeek(Tell());
+		}
+#endif // !defined(_WIN32)
+	}
+
+
+	size_t Tell() const
+	{
+		ThrowIfFilePtrIsNull();
+
+		auto cRes = CTell(m_filePtr);
+
+		return Internal::Obj::RealNumCast<size_t>(cRes);
+	}
+
+
+	void Flush()
+	{
+		ThrowIfFilePtrIsNull();
+
+		std::fflush(m_filePtr);
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		ThrowIfFilePtrIsNull();
+
+		auto cReadSize = std::fread(buffer, 1, size, m_filePtr);
+
+		size_t readSize = Internal::Obj::RealNumCast<size_t>(cReadSize);
+		if ((readSize < size) &&
+			(std::ferror(m_filePtr) != 0)
+			)
+		{
+			throw Exception("I/O error while reading the file");
+		}
+
+#if !defined(_WIN32)
+		if (m_advisor.IsTracking())
+		{
+			m_advisor.OnRead(::fileno(m_filePtr), readSize);
+		}
+#endif // !defined(_WIN32)
+
+		return readSize;
+	}
+
+
+	size_t WriteBytesRaw(const void* buffer, size_t size)
+	{
+		ThrowIfFilePtrIsNull();
+
+		auto cWriteSize = std::fwrite(buffer, 1, size, m_filePtr);
+
+		size_t writeSize = Internal::Obj::RealNumCast<size_t>(cWriteSize);
+		if ((writeSize < size) &&
+			(std::ferror(m_filePtr) != 0)
+			)
+		{
+			throw Exception("I/O error while writing the file");
+		}
+
+		return writeSize;
+	}
+
+
+	/**
+	 * @brief Advise the OS about how the file is going to be read
+	 *        NOTE: it is a no-op on Windows
+	 *
+	 * @param readaheadSize The size of the readahead window maintained as
+	 *                      the stream advances; zero to disable
+	 */
+	void SetAccessHint(AccessHint hint, size_t readaheadSize)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		(void)hint;
+		(void)readaheadSize;
+#else
+		m_advisor.Apply(::fileno(m_filePtr), Tell(), hint, readaheadSize);
+#endif // defined(_WIN32)
+	}
+
+
+	int GetNativeFD() const
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		return _fileno(m_filePtr);
+#else
+		return ::fileno(m_filePtr);
+#endif // defined(_WIN32)
+	}
+
+
+	/**
+	 * @brief Reserve disk space for a file expected to grow to
+	 *        `expectedSize` bytes; the file size is not changed, and the
+	 *        space not written is released when the file is closed.
+	 *        NOTE: it is a no-op where not supported (e.g., on Windows)
+	 */
+	void Preallocate(size_t expectedSize)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		(void)expectedSize;
+#else
+		if (FDCalls::Preallocate(::fileno(m_filePtr), expectedSize))
+		{
+			m_isPreallocated = true;
+		}
+#endif // defined(_WIN32)
+	}
+
+
+	/**
+	 * @brief Keep the metadata read by the first `GetStat` call for the
+	 *        lifetime of the handle, instead of calling `fstat` each time;
+	 *        only for files that do not change while they are open
+	 */
+	void EnableStatCache()
+	{
+		m_isStatCached = true;
+	}
+
+
+	/**
+	 * @brief Get the metadata of the file with one `fstat` call; the result
+	 *        is only reused if `EnableStatCache` has been called
+	 */
+	FileStat GetStat()
+	{
+		ThrowIfFilePtrIsNull();
+
+		if (m_hasStat)
+		{
+			return m_stat;
+		}
+
+		if (m_isWritable)
+		{
+			// data still in the stdio buffer counts towards the size
+			std::fflush(m_filePtr);
+		}
+
+#if defined(_WIN32)
+		struct _stat64 fileStat;
+		if (_fstat64(_fileno(m_filePtr), &fileStat) != 0)
+		{
+			throw Exception("I/O error while reading the file status");
+		}
+
+		FileStat res;
+		res.m_size = Internal::Obj::RealNumCast<size_t>(fileStat.st_size);
+		res.m_blockSize = 0;
+		res.m_modifiedTime =
+			std::chrono::system_clock::from_time_t(fileStat.st_mtime);
+#else
+		FileStat res = FDCalls::Stat(::fileno(m_filePtr));
+#endif // defined(_WIN32)
+
+		if (m_isStatCached)
+		{
+			m_stat = res;
+			m_hasStat = true;
+		}
+		return res;
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		// stdio merges small transfers in its own buffer already
+		size_t readSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			size_t segReadSize =
+				ReadBytesRaw(segments[i].data(), segments[i].size());
+			readSize += segReadSize;
+			if (segReadSize < segments[i].size())
+			{
+				break;
+			}
+		}
+		return readSize;
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			WriteBytesRaw(segments[i].data(), segments[i].size());
+		}
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		return AtPositionEmulated(
+			offset,
+			[this, buffer, size]()
+			{
+				return ReadBytesRaw(buffer, size);
+			}
+		);
+#else
+		if (m_isWritable)
+		{
+			// make sure pending writes are visible to the positional read
+			std::fflush(m_filePtr);
+		}
+
+		return FDCalls::PRead(::fileno(m_filePtr), offset, buffer, size);
+#endif // defined(_WIN32)
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		AtPositionEmulated(
+			offset,
+			[this, buffer, size]()
+			{
+				return WriteBytesRaw(buffer, size);
+			}
+		);
+#else
+		// write out pending data and drop any read-ahead buffer,
+		// so stdio will not go out of sync with the file
+		std::fflush(m_filePtr);
+
+		FDCalls::PWrite(::fileno(m_filePtr), offset, buffer, size);
+#endif // defined(_WIN32)
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		return AtPositionEmulated(
+			offset,
+			[this, segments, segCount]()
+			{
+				return ReadBytesVRaw(segments, segCount);
+			}
+		);
+#else
+		if (m_isWritable)
+		{
+			std::fflush(m_filePtr);
+		}
+
+		return FDCalls::PReadV(
+			::fileno(m_filePtr), offset, segments, segCount
+		);
+#endif // defined(_WIN32)
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		ThrowIfFilePtrIsNull();
+
+#if defined(_WIN32)
+		AtPositionEmulated(
+			offset,
+			[this, segments, segCount]() -> size_t
+			{
+				WriteBytesVRaw(segments, segCount);
+				return 0;
+			}
+		);
+#else
+		std::fflush(m_filePtr);
+
+		FDCalls::PWriteV(::fileno(m_filePtr), offset, segments, segCount);
+#endif // defined(_WIN32)
+	}
+
+
+private:
+
+
+	COpenImpl(std::FILE* filePtr, bool isWritable) noexcept :
+		m_filePtr(filePtr),
+		m_isWritable(isWritable),
+		m_isStatCached(false),
+		m_hasStat(false),
+		m_stat()
+#if defined(_WIN32)
+		,
+		m_atPosMutex()
+#else
+		,
+		m_advisor(),
+		m_isPreallocated(false)
+#endif // defined(_WIN32)
+	{}
+
+
+#if defined(_WIN32)
+	/**
+	 * @brief There is no positional read/write for stdio streams on Windows,
+	 *        so it is emulated by seeking back and forth while holding a lock.
+	 *        NOTE: it is only safe against other positional calls; it is not
+	 *        safe to use the cursor based calls concurrently.
+	 */
+	template<typename _CallType>
+	size_t AtPositionEmulated(size_t offset, _CallType call)
+	{
+		std::lock_guard<std::mutex> lock(m_atPosMutex);
+
+		auto origPos = CTell(m_filePtr);
+		CSeek(
+			m_filePtr,
+			Internal::Obj::RealNumCast<_COffsetType>(offset),
+			SEEK_SET
+		);
+		size_t res = call();
+		CSeek(m_filePtr, origPos, SEEK_SET);
+
+		return res;
+	}
+#endif // defined(_WIN32)
+
+
+	void ThrowIfFilePtrIsNull() const
+	{
+		if (m_filePtr == nullptr)
+		{
+			throw Exception("File is not opened");
+		}
+	}
+
+
+	std::FILE* m_filePtr;
+	bool m_isWritable;
+	bool m_isStatCached;
+	bool m_hasStat;
+	FileStat m_stat;
+#if defined(_WIN32)
+	std::mutex m_atPosMutex;
+#else
+	FileAdvisor m_advisor;
+	bool m_isPreallocated;
+#endif // defined(_WIN32)
+
+}; // class COpenImpl
+
+template<
+	template<typename> class _WrapperType,
+	typename _BaseType
+>
+struct COpenerImpl
+{
+
+	using ImplType = COpenImpl;
+	using WrapperType = _WrapperType<ImplType>;
+	using RetType = std::unique_ptr<_BaseType>;
+
+protected:
+
+	static RetType OpenImpl(
+		const std::string& path,
+		const std::string& mode
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+
+
+	static RetType OpenImpl(
+		const std::string& path,
+		const std::string& mode,
+		AccessHint hint,
+		size_t readaheadSize
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+		impl->SetAccessHint(hint, readaheadSize);
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+
+
+	static RetType OpenStatCachedImpl(
+		const std::string& path,
+		const std::string& mode
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+		impl->EnableStatCache();
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+
+
+	static RetType OpenPreallocatedImpl(
+		const std::string& path,
+		const std::string& mode,
+		size_t expectedSize
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+		impl->Preallocate(expectedSize);
 
-namespace SysCall
-{
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
 
-namespace SysCallInternal
-{
+}; // struct COpenerImpl
 
-class COpenImpl
+#if !defined(_WIN32)
+
+/**
+ * @brief File implementation built directly on top of a POSIX file
+ *        descriptor. Unlike `COpenImpl`, there is no intermediate buffer
+ *        in the user space, so data is read into (and written from) the
+ *        caller's buffer directly, and offsets are handled with `off_t`,
+ *        which is 64-bit wide on all supported platforms.
+ *        NOTE: since every call is a system call, consider using this
+ *        implementation for large reads and writes only.
+ */
+class FDOpenImpl
 {
 public: // static members:
 
-	static std::FILE* COpenS(
-		const std::string& path,
-		const std::string& mode
-	)
+	/**
+	 * @brief Translate a `fopen`-style mode string (e.g., "rb", "ab+") into
+	 *        the flags used by `open`
+	 *
+	 * @param mode The mode string
+	 * @return The flags to be passed to `open`
+	 */
+	static int ModeToFlags(const std::string& mode)
 	{
-		std::FILE* file = nullptr;
-#if defined(_WIN32)
-		auto err = fopen_s(&file, path.c_str(), mode.c_str());
-		if (err != 0)
+		const bool isPlus = (mode.find('+') != std::string::npos);
+
+		int flags = 0;
+		switch (mode.empty() ? '\0' : mode[0])
 		{
-			throw Exception("I/O error while opening the file at " + path);
+		case 'r':
+			flags = isPlus ? O_RDWR : O_RDONLY;
+			break;
+
+		case 'w':
+			flags = (isPlus ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC;
+			break;
+
+		case 'a':
+			flags = (isPlus ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND;
+			break;
+
+		default:
+			throw Exception("Invalid file open mode - " + mode);
 		}
-#else
-		file = std::fopen(path.c_str(), mode.c_str());
-		if (file == nullptr)
+
+		return flags | O_CLOEXEC;
+	}
+
+
+	static int FDOpenS(const std::string& path, int flags)
+	{
+		int fd = -1;
+		do
+		{
+			fd = ::open(path.c_str(), flags, 0666);
+		} while ((fd < 0) && (errno == EINTR));
+
+		if (fd < 0)
 		{
 			throw Exception("I/O error while opening the file at " + path);
 		}
-#endif // defined(_WIN32)
-		return file;
+		return fd;
 	}
 
 public:
 
-	COpenImpl(const std::string& path, const std::string& mode) :
-		COpenImpl(COpenS(path, mode))
+	FDOpenImpl(const std::string& path, const std::string& mode) :
+		FDOpenImpl(path, ModeToFlags(mode))
 	{}
 
 
-	~COpenImpl()
+	~FDOpenImpl()
 	{
-		if (m_filePtr != nullptr)
+		if (m_fd >= 0)
 		{
-			std::fclose(m_filePtr);
+			if (m_isPreallocated)
+			{
+				FDCalls::ReleasePreallocated(m_fd);
+			}
+			::close(m_fd);
 		}
 	}
 
@@ -84,166 +1336,482 @@ public:
 		SeekWhence whence = SeekWhence::Begin
 	)
 	{
-		ThrowIfFilePtrIsNull();
+		ThrowIfFDIsInvalid();
 
-		using _COffsetType = long;
-		_COffsetType cOffset =
-			Internal::Obj::RealNumCast<_COffsetType>(offset);
+		off_t cOffset = Internal::Obj::RealNumCast<off_t>(offset);
 
+		off_t res = -1;
 		switch (whence)
 		{
 		case SeekWhence::Begin:
-			std::fseek(m_filePtr, cOffset, SEEK_SET);
+			res = ::lseek(m_fd, cOffset, SEEK_SET);
 			break;
 
 		case SeekWhence::Current:
-			std::fseek(m_filePtr, cOffset, SEEK_CUR);
+			res = ::lseek(m_fd, cOffset, SEEK_CUR);
 			break;
 
 		case SeekWhence::End:
-			std::fseek(m_filePtr, cOffset, SEEK_END);
+			res = ::lseek(m_fd, cOffset, SEEK_END);
 			break;
 
 		default:
 			throw Exception("Invalid SeekWhence value");
 		}
+
+		if (res < 0)
+		{
+			throw Exception("I/O error while seeking the file");
+		}
+
+		if (m_advisor.IsTracking())
+		{
+			m_advisor.OnSeek(Internal::Obj::RealNumCast<size_t>(res));
+		}
 	}
 
 
 	size_t Tell() const
 	{
-		ThrowIfFilePtrIsNull();
+		ThrowIfFDIsInvalid();
 
-		auto cRes = std::ftell(m_filePtr);
+		off_t res = ::lseek(m_fd, 0, SEEK_CUR);
+		if (res < 0)
+		{
+			throw Exception("I/O error while telling the file position");
+		}
 
-		return Internal::Obj::RealNumCast<size_t>(cRes);
+		return Internal::Obj::RealNumCast<size_t>(res);
 	}
 
 
 	void Flush()
 	{
-		ThrowIfFilePtrIsNull();
+		ThrowIfFDIsInvalid();
 
-		std::fflush(m_filePtr);
+		// There is no user space buffer to be flushed;
+		// data is handed to the OS on every write
 	}
 
 
 	size_t ReadBytesRaw(void* buffer, size_t size)
 	{
-		ThrowIfFilePtrIsNull();
+		ThrowIfFDIsInvalid();
 
-		auto cReadSize = std::fread(buffer, 1, size, m_filePtr);
-
-		size_t readSize = Internal::Obj::RealNumCast<size_t>(cReadSize);
-		if ((readSize < size) &&
-			(std::ferror(m_filePtr) != 0)
-			)
+		size_t readSize = FDCalls::Read(m_fd, buffer, size);
+		if (m_advisor.IsTracking())
 		{
-			throw Exception("I/O error while reading the file");
+			m_advisor.OnRead(m_fd, readSize);
 		}
-
 		return readSize;
 	}
 
 
 	size_t WriteBytesRaw(const void* buffer, size_t size)
 	{
-		ThrowIfFilePtrIsNull();
+		ThrowIfFDIsInvalid();
 
-		auto cWriteSize = std::fwrite(buffer, 1, size, m_filePtr);
+		return FDCalls::Write(m_fd, buffer, size);
+	}
 
-		size_t writeSize = Internal::Obj::RealNumCast<size_t>(cWriteSize);
-		if ((writeSize < size) &&
-			(std::ferror(m_filePtr) != 0)
-			)
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size) const
+	{
+		ThrowIfFDIsInvalid();
+
+		return FDCalls::PRead(m_fd, offset, buffer, size);
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		ThrowIfFDIsInvalid();
+
+		FDCalls::PWrite(m_fd, offset, buffer, size);
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		ThrowIfFDIsInvalid();
+
+		size_t readSize = FDCalls::ReadV(m_fd, segments, segCount);
+		if (m_advisor.IsTracking())
 		{
-			throw Exception("I/O error while writing the file");
+			m_advisor.OnRead(m_fd, readSize);
 		}
+		return readSize;
+	}
 
-		return writeSize;
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		ThrowIfFDIsInvalid();
+
+		FDCalls::WriteV(m_fd, segments, segCount);
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) const
+	{
+		ThrowIfFDIsInvalid();
+
+		return FDCalls::PReadV(m_fd, offset, segments, segCount);
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		ThrowIfFDIsInvalid();
+
+		FDCalls::PWriteV(m_fd, offset, segments, segCount);
+	}
+
+
+	int GetFD() const
+	{
+		return m_fd;
+	}
+
+
+	int GetNativeFD() const
+	{
+		return m_fd;
+	}
+
+
+	/**
+	 * @brief Advise the OS about how the file is going to be read
+	 *
+	 * @param readaheadSize The size of the readahead window maintained as
+	 *                      the stream advances; zero to disable
+	 */
+	void SetAccessHint(AccessHint hint, size_t readaheadSize)
+	{
+		ThrowIfFDIsInvalid();
+
+		m_advisor.Apply(m_fd, Tell(), hint, readaheadSize);
+	}
+
+
+	/**
+	 * @brief Reserve disk space for a file expected to grow to
+	 *        `expectedSize` bytes; the file size is not changed, and the
+	 *        space not written is released when the file is closed
+	 */
+	void Preallocate(size_t expectedSize)
+	{
+		ThrowIfFDIsInvalid();
+
+		if (FDCalls::Preallocate(m_fd, expectedSize))
+		{
+			m_isPreallocated = true;
+		}
+	}
+
+
+	/**
+	 * @brief Make the data written so far durable on the storage device
+	 *
+	 * @param dataOnly Only flush the data, and the metadata needed to
+	 *                 retrieve the data (i.e., `fdatasync`)
+	 */
+	void Sync(bool dataOnly)
+	{
+		ThrowIfFDIsInvalid();
+
+		int res = 0;
+		do
+		{
+#if defined(__APPLE__)
+			// there is no `fdatasync` on macOS
+			(void)dataOnly;
+			res = ::fsync(m_fd);
+#else
+			res = dataOnly ? ::fdatasync(m_fd) : ::fsync(m_fd);
+#endif // defined(__APPLE__)
+		} while ((res != 0) && (errno == EINTR));
+
+		if (res != 0)
+		{
+			throw Exception("I/O error while syncing the file");
+		}
+	}
+
+
+	/**
+	 * @brief Keep the metadata read by the first `GetStat` call for the
+	 *        lifetime of the handle, instead of calling `fstat` each time;
+	 *        only for files that do not change while they are open
+	 */
+	void EnableStatCache()
+	{
+		m_isStatCached = true;
+	}
+
+
+	/**
+	 * @brief Get the metadata of the file with one `fstat` call; the result
+	 *        is only reused if `EnableStatCache` has been called
+	 */
+	FileStat GetStat()
+	{
+		ThrowIfFDIsInvalid();
+
+		if (m_hasStat)
+		{
+			return m_stat;
+		}
+
+		FileStat res = FDCalls::Stat(m_fd);
+		if (m_isStatCached)
+		{
+			m_stat = res;
+			m_hasStat = true;
+		}
+		return res;
 	}
 
 
 private:
 
 
-	COpenImpl(std::FILE* filePtr) noexcept :
-		m_filePtr(filePtr)
+	FDOpenImpl(const std::string& path, int flags) :
+		m_fd(FDOpenS(path, flags)),
+		m_isStatCached(false),
+		m_hasStat(false),
+		m_stat(),
+		m_advisor(),
+		m_isPreallocated(false)
 	{}
 
 
-	void ThrowIfFilePtrIsNull() const
+	void ThrowIfFDIsInvalid() const
 	{
-		if (m_filePtr == nullptr)
+		if (m_fd < 0)
 		{
 			throw Exception("File is not opened");
 		}
 	}
 
 
-	std::FILE* m_filePtr;
+	int m_fd;
+	bool m_isStatCached;
+	bool m_hasStat;
+	FileStat m_stat;
+	FileAdvisor m_advisor;
+	bool m_isPreallocated;
 
-}; // class COpenImpl
+}; // class FDOpenImpl
 
 template<
 	template<typename> class _WrapperType,
 	typename _BaseType
 >
-struct COpenerImpl
+struct FDOpenerImpl
 {
 
-	using ImplType = COpenImpl;
-	using WrapperType = _WrapperType<ImplType>;
-	using RetType = std::unique_ptr<_BaseType>;
+	using FDImplType = FDOpenImpl;
+	using FDWrapperType = _WrapperType<FDImplType>;
 
 protected:
 
-	static RetType OpenImpl(
+	static std::unique_ptr<_BaseType> OpenFDImpl(
 		const std::string& path,
 		const std::string& mode
 	)
 	{
 		auto impl =
-			Internal::Obj::Internal::make_unique<ImplType>(path, mode);
+			Internal::Obj::Internal::make_unique<FDImplType>(path, mode);
 
 		return
-			Internal::Obj::Internal::make_unique<WrapperType>(
+			Internal::Obj::Internal::make_unique<FDWrapperType>(
 				std::move(impl)
 			);
 	}
 
-}; // struct COpenerImpl
+
+	static std::unique_ptr<_BaseType> OpenFDImpl(
+		const std::string& path,
+		const std::string& mode,
+		AccessHint hint,
+		size_t readaheadSize
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<FDImplType>(path, mode);
+		impl->SetAccessHint(hint, readaheadSize);
+
+		return
+			Internal::Obj::Internal::make_unique<FDWrapperType>(
+				std::move(impl)
+			);
+	}
+
+
+	static std::unique_ptr<_BaseType> OpenStatCachedFDImpl(
+		const std::string& path,
+		const std::string& mode
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<FDImplType>(path, mode);
+		impl->EnableStatCache();
+
+		return
+			Internal::Obj::Internal::make_unique<FDWrapperType>(
+				std::move(impl)
+			);
+	}
+
+
+	static std::unique_ptr<_BaseType> OpenPreallocatedFDImpl(
+		const std::string& path,
+		const std::string& mode,
+		size_t expectedSize
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<FDImplType>(path, mode);
+		impl->Preallocate(expectedSize);
+
+		return
+			Internal::Obj::Internal::make_unique<FDWrapperType>(
+				std::move(impl)
+			);
+	}
+
+}; // struct FDOpenerImpl
+
+#endif // !defined(_WIN32)
 
 } // namespace SysCallInternal
 
 
 struct RBinaryFile :
 	SysCallInternal::COpenerImpl<RBinaryIOSWrapper, RBinaryIOSBase>
+#if !defined(_WIN32)
+	, SysCallInternal::FDOpenerImpl<RBinaryIOSWrapper, RBinaryIOSBase>
+#endif // !defined(_WIN32)
 {
 	static RetType Open(const std::string& path)
 	{
 		return OpenImpl(path, "rb");
 	}
+
+	/**
+	 * @brief Open the file, and advise the OS about how it is going to be read
+	 *
+	 * @param hint          The access pattern
+	 * @param readaheadSize The size of the readahead window; if it is not
+	 *                      zero, loading of the next `readaheadSize` bytes
+	 *                      is started in the background as the stream advances
+	 */
+	static RetType Open(
+		const std::string& path,
+		AccessHint hint,
+		size_t readaheadSize = 0
+	)
+	{
+		return OpenImpl(path, "rb", hint, readaheadSize);
+	}
+
+	/**
+	 * @brief Open a file that is not going to change while it is open;
+	 *        its metadata (e.g., the size) is read once, and `GetStat` and
+	 *        `GetFileSize` are answered without any system call afterwards
+	 */
+	static RetType OpenStatCached(const std::string& path)
+	{
+		return OpenStatCachedImpl(path, "rb");
+	}
+
+#if !defined(_WIN32)
+	/**
+	 * @brief Open the file with the file descriptor based implementation,
+	 *        which reads straight into the caller's buffer, bypassing
+	 *        the stdio buffer
+	 */
+	static RetType OpenFD(const std::string& path)
+	{
+		return OpenFDImpl(path, "rb");
+	}
+
+	static RetType OpenFD(
+		const std::string& path,
+		AccessHint hint,
+		size_t readaheadSize = 0
+	)
+	{
+		return OpenFDImpl(path, "rb", hint, readaheadSize);
+	}
+
+	static RetType OpenStatCachedFD(const std::string& path)
+	{
+		return OpenStatCachedFDImpl(path, "rb");
+	}
+#endif // !defined(_WIN32)
 }; // struct RBinaryFile
 
 
 struct WBinaryFile :
 	SysCallInternal::COpenerImpl<WBinaryIOSWrapper, WBinaryIOSBase>
+#if !defined(_WIN32)
+	, SysCallInternal::FDOpenerImpl<WBinaryIOSWrapper, WBinaryIOSBase>
+#endif // !defined(_WIN32)
 {
 	static RetType Create(const std::string& path)
 	{
 		return OpenImpl(path, "wb");
 	}
 
+	/**
+	 * @brief Create the file, and reserve disk space for the size it is
+	 *        expected to grow to, so it can be written in contiguous
+	 *        extents; the space not written is released when it is closed
+	 */
+	static RetType Create(const std::string& path, size_t expectedSize)
+	{
+		return OpenPreallocatedImpl(path, "wb", expectedSize);
+	}
+
 	static RetType Append(const std::string& path)
 	{
 		return OpenImpl(path, "ab");
 	}
+
+#if !defined(_WIN32)
+	static RetType CreateFD(const std::string& path)
+	{
+		return OpenFDImpl(path, "wb");
+	}
+
+	static RetType CreateFD(const std::string& path, size_t expectedSize)
+	{
+		return OpenPreallocatedFDImpl(path, "wb", expectedSize);
+	}
+
+	static RetType AppendFD(const std::string& path)
+	{
+		return OpenFDImpl(path, "ab");
+	}
+#endif // !defined(_WIN32)
 }; // struct WBinaryFile
 
 
 struct RWBinaryFile :
 	SysCallInternal::COpenerImpl<RWBinaryIOSWrapper, RWBinaryIOSBase>
+#if !defined(_WIN32)
+	, SysCallInternal::FDOpenerImpl<RWBinaryIOSWrapper, RWBinaryIOSBase>
+#endif // !defined(_WIN32)
 {
 	using ImplType = SysCallInternal::COpenImpl;
 	using WrapperType = RWBinaryIOSWrapper<ImplType>;
@@ -255,10 +1823,35 @@ struct RWBinaryFile :
 		return OpenImpl(path, "wb+");
 	}
 
+	/**
+	 * @brief Same as `WBinaryFile::Create(path, expectedSize)`
+	 */
+	static RetType Create(const std::string& path, size_t expectedSize)
+	{
+		return OpenPreallocatedImpl(path, "wb+", expectedSize);
+	}
+
 	static RetType Append(const std::string& path)
 	{
 		return OpenImpl(path, "ab+");
 	}
+
+#if !defined(_WIN32)
+	static RetType CreateFD(const std::string& path)
+	{
+		return OpenFDImpl(path, "wb+");
+	}
+
+	static RetType CreateFD(const std::string& path, size_t expectedSize)
+	{
+		return OpenPreallocatedFDImpl(path, "wb+", expectedSize);
+	}
+
+	static RetType AppendFD(const std::string& path)
+	{
+		return OpenFDImpl(path, "ab+");
+	}
+#endif // !defined(_WIN32)
 }; // struct RWBinaryFile
 
 
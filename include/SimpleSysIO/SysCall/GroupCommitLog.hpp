@@ -0,0 +1,378 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#if defined(SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM) && !defined(_WIN32)
+
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../BytesView.hpp"
+#include "../Exceptions.hpp"
+#include "../Internal/SimpleObjects.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief A durable, append-only log shared by concurrent producers.
+ *        Records submitted by producers are queued, and a background
+ *        committer thread writes all queued records with one gathered write,
+ *        followed by one `fdatasync`, and then reports to each producer that
+ *        its record is durable. While one commit is in progress, new records
+ *        accumulate for the next one, so the cost of a sync is shared by
+ *        all records in the group.
+ *        Records are appended as they are; any framing is up to the caller.
+ *        NOTE: if a commit fails, the records in it, and all records
+ *        submitted afterwards, are reported as failed, since the state of
+ *        the end of the file is unknown.
+ */
+class GroupCommitLog
+{
+public: // static members:
+
+	using CommitCallback = std::function<void(bool)>;
+
+	static constexpr size_t sk_defMaxBatchSize = 4 * 1024 * 1024;
+
+
+	/**
+	 * @brief Open the log file at the given path, which is created if it
+	 *        does not exist
+	 *
+	 * @param commitWindow How long the committer waits, after the first
+	 *                     record of a group arrives, for more records to
+	 *                     join the group; zero means a group is made of the
+	 *                     records queued while the previous commit is
+	 *                     in progress
+	 * @param maxBatchSize The committer stops waiting once the queued
+	 *                     records reach this size, in bytes, and each
+	 *                     commit writes at most this many bytes (a larger
+	 *                     record is committed in a group of its own)
+	 */
+	static std::unique_ptr<GroupCommitLog> Open(
+		const std::string& path,
+		std::chrono::microseconds commitWindow =
+			std::chrono::microseconds(0),
+		size_t maxBatchSize = sk_defMaxBatchSize
+	)
+	{
+		return Internal::Obj::Internal::make_unique<GroupCommitLog>(
+			Internal::Obj::Internal::make_unique<
+				SysCallInternal::FDOpenImpl
+			>(path, "ab"),
+			commitWindow,
+			maxBatchSize
+		);
+	}
+
+public:
+
+	GroupCommitLog(
+		std::unique_ptr<SysCallInternal::FDOpenImpl> file,
+		std::chrono::microseconds commitWindow,
+		size_t maxBatchSize
+	) :
+		m_file(std::move(file)),
+		m_commitWindow(commitWindow),
+		m_maxBatchSize(maxBatchSize),
+		m_mutex(),
+		m_cond(),
+		m_pending(),
+		m_pendingSize(0),
+		m_isStopping(false),
+		m_hasFailed(false),
+		m_numCommits(0),
+		m_committer()
+	{
+		m_committer = std::thread(&GroupCommitLog::CommitterMain, this);
+	}
+
+
+	GroupCommitLog(const GroupCommitLog&) = delete;
+
+
+	/**
+	 * @brief Commit all records queued, and then stop the committer
+	 */
+	~GroupCommitLog()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_cond.notify_all();
+		m_committer.join();
+	}
+
+
+	GroupCommitLog& operator=(const GroupCommitLog&) = delete;
+
+
+	/**
+	 * @brief Submit a record to be appended; this function returns
+	 *        immediately, and `callback` is called, on the committer thread,
+	 *        once the record is durable (or the commit fails).
+	 *        NOTE: callbacks should be short and must not throw; exceptions
+	 *        thrown by them are ignored.
+	 *
+	 * @param record The bytes to be appended
+	 * @param callback Called with `true` if an error has occurred
+	 */
+	void Append(std::vector<uint8_t> record, CommitCallback callback)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_isStopping)
+			{
+				throw Exception("The log is being closed");
+			}
+
+			if (!m_hasFailed)
+			{
+				m_pendingSize += record.size();
+				m_pending.emplace_back(std::move(record), std::move(callback));
+				m_cond.notify_all();
+				return;
+			}
+		}
+
+		// the log has failed; report right away
+		InvokeCallback(callback, true);
+	}
+
+
+	/**
+	 * @brief Submit a record to be appended, and wait until it is durable
+	 *
+	 * @exception Exception if the commit fails
+	 */
+	void AppendSync(std::vector<uint8_t> record)
+	{
+		std::shared_ptr<std::promise<bool> > promise =
+			std::make_shared<std::promise<bool> >();
+		std::future<bool> future = promise->get_future();
+
+		Append(
+			std::move(record),
+			[promise](bool hasErrorOccurred)
+			{
+				promise->set_value(hasErrorOccurred);
+			}
+		);
+
+		if (future.get())
+		{
+			throw Exception("I/O error while committing the record");
+		}
+	}
+
+
+	/**
+	 * @brief Get the number of commits (i.e., write and sync pairs) done
+	 *        so far
+	 */
+	size_t GetNumCommits() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_numCommits;
+	}
+
+
+private:
+
+	struct PendingRecord
+	{
+		PendingRecord(std::vector<uint8_t> data, CommitCallback callback) :
+			m_data(std::move(data)),
+			m_callback(std::move(callback))
+		{}
+
+		std::vector<uint8_t> m_data;
+		CommitCallback m_callback;
+	}; // struct PendingRecord
+
+
+	static void InvokeCallback(
+		const CommitCallback& callback,
+		bool hasErrorOccurred
+	) noexcept
+	{
+		if (callback)
+		{
+			try
+			{
+				callback(hasErrorOccurred);
+			}
+			catch (...)
+			{}
+		}
+	}
+
+
+	/**
+	 * @brief Move the queued records, up to `m_maxBatchSize` bytes (but at
+	 *        least one record), into `group`; the rest stay queued for the
+	 *        next commit
+	 */
+	void TakeGroup(std::vector<PendingRecord>& group)
+	{
+		size_t groupSize = 0;
+		size_t numTaken = 0;
+		while (
+			(numTaken < m_pending.size()) &&
+			(
+				(numTaken == 0) ||
+				(m_pending[numTaken].m_data.size() <=
+					m_maxBatchSize - groupSize)
+			)
+		)
+		{
+			groupSize += m_pending[numTaken].m_data.size();
+			++numTaken;
+		}
+
+		if (numTaken == m_pending.size())
+		{
+			group.swap(m_pending);
+		}
+		else
+		{
+			for (size_t i = 0; i < numTaken; ++i)
+			{
+				group.emplace_back(std::move(m_pending[i]));
+			}
+			m_pending.erase(m_pending.begin(), m_pending.begin() + numTaken);
+		}
+		m_pendingSize -= groupSize;
+	}
+
+
+	void CommitterMain()
+	{
+		std::vector<PendingRecord> group;
+		std::vector<ConstBytesView> segments;
+
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cond.wait(
+					lock,
+					[this]()
+					{
+						return m_isStopping || !m_pending.empty();
+					}
+				);
+				if (m_pending.empty())
+				{
+					// stopping, and everything has been committed
+					return;
+				}
+
+				if (m_commitWindow.count() > 0)
+				{
+					// give other producers a chance to join this group
+					m_cond.wait_for(
+						lock,
+						m_commitWindow,
+						[this]()
+						{
+							return m_isStopping ||
+								(m_pendingSize >= m_maxBatchSize);
+						}
+					);
+				}
+
+				TakeGroup(group);
+			}
+
+			bool hasErrorOccurred = false;
+			try
+			{
+				segments.clear();
+				for (const auto& record : group)
+				{
+					segments.emplace_back(
+						record.m_data.data(),
+						record.m_data.size()
+					);
+				}
+				m_file->WriteBytesVRaw(segments.data(), segments.size());
+				m_file->Sync(true);
+			}
+			catch (...)
+			{
+				hasErrorOccurred = true;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				++m_numCommits;
+				if (hasErrorOccurred)
+				{
+					m_hasFailed = true;
+					// records queued meanwhile are not going to be written
+					for (auto& record : m_pending)
+					{
+						group.emplace_back(std::move(record));
+					}
+					m_pending.clear();
+					m_pendingSize = 0;
+				}
+			}
+
+			for (const auto& record : group)
+			{
+				InvokeCallback(record.m_callback, hasErrorOccurred);
+			}
+			group.clear();
+		}
+	}
+
+
+	std::unique_ptr<SysCallInternal::FDOpenImpl> m_file;
+	std::chrono::microseconds m_commitWindow;
+	size_t m_maxBatchSize;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::vector<PendingRecord> m_pending;
+	size_t m_pendingSize;
+	bool m_isStopping;
+	bool m_hasFailed;
+	size_t m_numCommits;
+
+	std::thread m_committer;
+
+}; // class GroupCommitLog
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM && !_WIN32
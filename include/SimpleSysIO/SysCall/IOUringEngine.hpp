@@ -0,0 +1,637 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#if defined(SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM) && defined(__linux__)
+#	if defined(__has_include)
+#		if __has_include(<linux/io_uring.h>)
+#			define SIMPLESYSIO_SYSCALL_HAS_IO_URING
+#		endif
+#	endif
+#endif
+
+
+#ifdef SIMPLESYSIO_SYSCALL_HAS_IO_URING
+
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../Exceptions.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief An asynchronous file I/O engine built on Linux io_uring.
+ *        Operations are queued into the submission ring without any system
+ *        call, and handed to the kernel in batches by `Submit()`, `Poll()` or
+ *        `Wait()`; completions are delivered by invoking the callbacks from
+ *        `Poll()` and `Wait()`, on the calling thread.
+ *        The callback follows the same `(buffer, hasErrorOccurred)`
+ *        convention as `StreamSocketBase::AsyncRecvCallback`:
+ *        - read:  the buffer holds the bytes read (shorter than requested if
+ *                 the end of the file is reached);
+ *        - write: the buffer written is handed back, so it can be reused;
+ *        - fsync: the buffer is empty.
+ *        NOTE: if a callback throws, the other callbacks of the same batch
+ *        of completions are still invoked, and then the first exception is
+ *        rethrown from `Poll()` or `Wait()`.
+ *        NOTE: the engine is not thread-safe; it is meant to be driven by
+ *        one thread, which can keep many operations in flight.
+ *        NOTE: files must stay open until their operations complete.
+ */
+class IOUringEngine
+{
+public: // static members:
+
+	using AsyncFileCallback = std::function<void(std::vector<uint8_t>, bool)>;
+
+	static constexpr uint32_t sk_defEntries = 256;
+
+	// the maximum size of a single request handed to the kernel; larger
+	// operations are split into multiple requests
+	static constexpr size_t sk_maxRequestSize = 0x40000000;
+
+
+	static std::shared_ptr<IOUringEngine> Create(
+		uint32_t entries = sk_defEntries
+	)
+	{
+		return std::shared_ptr<IOUringEngine>(new IOUringEngine(entries));
+	}
+
+public:
+
+	IOUringEngine(const IOUringEngine&) = delete;
+
+
+	~IOUringEngine()
+	{
+		// the kernel may still be using the buffers of in-flight operations,
+		// so they have to be completed before the memory is released;
+		// their callbacks are not called
+		try
+		{
+			Submit();
+			while (m_numInFlight > 0)
+			{
+				Enter(1, true);
+				ReapCompletions(false);
+			}
+		}
+		catch (...)
+		{}
+
+		UnmapRings();
+		::close(m_ringFd);
+	}
+
+
+	IOUringEngine& operator=(const IOUringEngine&) = delete;
+
+
+	/**
+	 * @brief Queue a read of up to `size` bytes at `offset`
+	 */
+	void AsyncRead(
+		int fd,
+		size_t offset,
+		size_t size,
+		AsyncFileCallback callback
+	)
+	{
+		std::unique_ptr<Operation> op(new Operation(
+			IORING_OP_READ,
+			fd,
+			offset,
+			std::vector<uint8_t>(size),
+			std::move(callback)
+		));
+		Queue(std::move(op));
+	}
+
+
+	/**
+	 * @brief Queue a write of all bytes in `data` at `offset`
+	 */
+	void AsyncWrite(
+		int fd,
+		size_t offset,
+		std::vector<uint8_t> data,
+		AsyncFileCallback callback
+	)
+	{
+		std::unique_ptr<Operation> op(new Operation(
+			IORING_OP_WRITE,
+			fd,
+			offset,
+			std::move(data),
+			std::move(callback)
+		));
+		Queue(std::move(op));
+	}
+
+
+	/**
+	 * @brief Queue a `fsync` (or `fdatasync` if `dataOnly` is true)
+	 *        NOTE: it is not ordered with other operations in flight; queue
+	 *        it after the writes it should cover have completed
+	 */
+	void AsyncFsync(int fd, bool dataOnly, AsyncFileCallback callback)
+	{
+		std::unique_ptr<Operation> op(new Operation(
+			IORING_OP_FSYNC,
+			fd,
+			0,
+			std::vector<uint8_t>(),
+			std::move(callback)
+		));
+		op->m_fsyncFlags = dataOnly ? IORING_FSYNC_DATASYNC : 0;
+		Queue(std::move(op));
+	}
+
+
+	/**
+	 * @brief Hand all queued operations to the kernel with one system call
+	 *
+	 * @return The number of operations submitted
+	 */
+	size_t Submit()
+	{
+		return Enter(0, false);
+	}
+
+
+	/**
+	 * @brief Submit queued operations, and then handle completions that are
+	 *        already available, without waiting
+	 *
+	 * @return The number of completions handled
+	 */
+	size_t Poll()
+	{
+		Submit();
+		return ReapCompletions(true);
+	}
+
+
+	/**
+	 * @brief Submit queued operations, and then wait until at least
+	 *        `minComplete` operations have completed (or all of the in-flight
+	 *        ones, if there are fewer), and handle the completions
+	 *
+	 * @return The number of completions handled
+	 */
+	size_t Wait(size_t minComplete = 1)
+	{
+		size_t handled = 0;
+		while (handled < minComplete && m_numInFlight > 0)
+		{
+			Enter(1, true);
+			handled += ReapCompletions(true);
+		}
+		return handled;
+	}
+
+
+	/**
+	 * @brief Get the number of operations that have been queued but not
+	 *        completed yet
+	 */
+	size_t GetNumInFlight() const
+	{
+		return m_numInFlight;
+	}
+
+
+private:
+
+	struct Operation
+	{
+		Operation(
+			uint8_t opcode,
+			int fd,
+			size_t offset,
+			std::vector<uint8_t> buffer,
+			AsyncFileCallback callback
+		) :
+			m_opcode(opcode),
+			m_fd(fd),
+			m_offset(offset),
+			m_buffer(std::move(buffer)),
+			m_done(0),
+			m_reqSize(0),
+			m_fsyncFlags(0),
+			m_callback(std::move(callback))
+		{}
+
+		uint8_t m_opcode;
+		int m_fd;
+		size_t m_offset;
+		std::vector<uint8_t> m_buffer;
+		size_t m_done;
+		size_t m_reqSize;
+		uint32_t m_fsyncFlags;
+		AsyncFileCallback m_callback;
+	}; // struct Operation
+
+
+	IOUringEngine(uint32_t entries) :
+		m_ringFd(-1),
+		m_params(),
+		m_sqRing(nullptr),
+		m_sqRingSize(0),
+		m_cqRing(nullptr),
+		m_cqRingSize(0),
+		m_sqes(nullptr),
+		m_sqesSize(0),
+		m_sqHead(nullptr),
+		m_sqTail(nullptr),
+		m_sqMask(0),
+		m_sqArray(nullptr),
+		m_cqHead(nullptr),
+		m_cqTail(nullptr),
+		m_cqMask(0),
+		m_cqes(nullptr),
+		m_numQueued(0),
+		m_numInFlight(0)
+	{
+		std::memset(&m_params, 0, sizeof(m_params));
+		m_ringFd = static_cast<int>(
+			::syscall(__NR_io_uring_setup, entries, &m_params)
+		);
+		if (m_ringFd < 0)
+		{
+			throw Exception("Failed to set up the io_uring instance");
+		}
+
+		try
+		{
+			MapRings();
+		}
+		catch (...)
+		{
+			UnmapRings();
+			::close(m_ringFd);
+			throw;
+		}
+	}
+
+
+	void MapRings()
+	{
+		m_sqRingSize =
+			m_params.sq_off.array + m_params.sq_entries * sizeof(uint32_t);
+		m_cqRingSize =
+			m_params.cq_off.cqes +
+			m_params.cq_entries * sizeof(struct io_uring_cqe);
+
+		const bool isSingleMap =
+			(m_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (isSingleMap)
+		{
+			m_sqRingSize = m_cqRingSize = (m_sqRingSize > m_cqRingSize) ?
+				m_sqRingSize : m_cqRingSize;
+		}
+
+		m_sqRing = MapRegion(m_sqRingSize, IORING_OFF_SQ_RING);
+		m_cqRing = isSingleMap ?
+			m_sqRing : MapRegion(m_cqRingSize, IORING_OFF_CQ_RING);
+
+		m_sqesSize = m_params.sq_entries * sizeof(struct io_uring_sqe);
+		m_sqes = static_cast<struct io_uring_sqe*>(
+			MapRegion(m_sqesSize, IORING_OFF_SQES)
+		);
+
+		uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+		m_sqHead = reinterpret_cast<uint32_t*>(sq + m_params.sq_off.head);
+		m_sqTail = reinterpret_cast<uint32_t*>(sq + m_params.sq_off.tail);
+		m_sqMask = *reinterpret_cast<uint32_t*>(
+			sq + m_params.sq_off.ring_mask
+		);
+		m_sqArray = reinterpret_cast<uint32_t*>(sq + m_params.sq_off.array);
+
+		uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+		m_cqHead = reinterpret_cast<uint32_t*>(cq + m_params.cq_off.head);
+		m_cqTail = reinterpret_cast<uint32_t*>(cq + m_params.cq_off.tail);
+		m_cqMask = *reinterpret_cast<uint32_t*>(
+			cq + m_params.cq_off.ring_mask
+		);
+		m_cqes = reinterpret_cast<struct io_uring_cqe*>(
+			cq + m_params.cq_off.cqes
+		);
+	}
+
+
+	void* MapRegion(size_t size, uint64_t offset)
+	{
+		void* ptr = ::mmap(
+			nullptr,
+			size,
+			PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE,
+			m_ringFd,
+			static_cast<off_t>(offset)
+		);
+		if (ptr == MAP_FAILED)
+		{
+			throw Exception("Failed to map the io_uring rings");
+		}
+		return ptr;
+	}
+
+
+	void UnmapRings() noexcept
+	{
+		if (m_sqes != nullptr)
+		{
+			::munmap(m_sqes, m_sqesSize);
+			m_sqes = nullptr;
+		}
+		if ((m_cqRing != nullptr) && (m_cqRing != m_sqRing))
+		{
+			::munmap(m_cqRing, m_cqRingSize);
+		}
+		m_cqRing = nullptr;
+		if (m_sqRing != nullptr)
+		{
+			::munmap(m_sqRing, m_sqRingSize);
+			m_sqRing = nullptr;
+		}
+	}
+
+
+	void Queue(std::unique_ptr<Operation> op)
+	{
+		// keep the number of in-flight operations within the capacity of
+		// the completion ring, so completions will never be dropped
+		while (m_numInFlight >= m_params.cq_entries)
+		{
+			Wait(1);
+		}
+
+		PushSqe(*op);
+		op.release();
+		++m_numInFlight;
+	}
+
+
+	void PushSqe(Operation& op)
+	{
+		while ((*m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE)) >=
+			m_params.sq_entries)
+		{
+			// the submission ring is full; the slot can only be reused once
+			// the kernel has consumed the entry in it
+			if (Submit() == 0)
+			{
+				// the kernel cannot take more for now (e.g., the completion
+				// ring is under pressure), so make room by handling
+				// completions
+				if (Wait(1) == 0)
+				{
+					throw Exception("The io_uring submission ring is full");
+				}
+			}
+		}
+		// callbacks called above may have queued more
+		uint32_t tail = *m_sqTail;
+
+		uint32_t index = tail & m_sqMask;
+		struct io_uring_sqe* sqe = &m_sqes[index];
+		std::memset(sqe, 0, sizeof(*sqe));
+
+		sqe->opcode = op.m_opcode;
+		sqe->fd = op.m_fd;
+		sqe->off = static_cast<uint64_t>(op.m_offset + op.m_done);
+		sqe->addr = reinterpret_cast<uint64_t>(op.m_buffer.data() + op.m_done);
+		op.m_reqSize = op.m_buffer.size() - op.m_done;
+		if (op.m_reqSize > sk_maxRequestSize)
+		{
+			op.m_reqSize = sk_maxRequestSize;
+		}
+		sqe->len = static_cast<uint32_t>(op.m_reqSize);
+		sqe->fsync_flags = op.m_fsyncFlags;
+		sqe->user_data = reinterpret_cast<uint64_t>(&op);
+
+		m_sqArray[index] = index;
+		__atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+		++m_numQueued;
+	}
+
+
+	size_t Enter(uint32_t minComplete, bool wait)
+	{
+		uint32_t toSubmit = m_numQueued;
+		if (toSubmit == 0 && !wait)
+		{
+			return 0;
+		}
+
+		int res = 0;
+		do
+		{
+			res = static_cast<int>(::syscall(
+				__NR_io_uring_enter,
+				m_ringFd,
+				toSubmit,
+				minComplete,
+				wait ? IORING_ENTER_GETEVENTS : 0,
+				nullptr,
+				0
+			));
+		} while ((res < 0) && (errno == EINTR));
+
+		if ((res < 0) && ((errno == EBUSY) || (errno == EAGAIN)))
+		{
+			// nothing is taken for now; completions need to be handled
+			// first
+			res = 0;
+		}
+		if (res < 0)
+		{
+			throw Exception("Failed to submit operations to io_uring");
+		}
+
+		m_numQueued -= static_cast<uint32_t>(res);
+		return static_cast<size_t>(res);
+	}
+
+
+	size_t ReapCompletions(bool invokeCallbacks)
+	{
+		uint32_t head = *m_cqHead;
+		uint32_t tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+		// take the ownership of all completed operations, and release the
+		// ring entries, before anything else, so nothing is leaked (or
+		// counted as in flight forever) if a callback throws
+		std::vector<std::pair<std::unique_ptr<Operation>, int32_t> > completed;
+		completed.reserve(tail - head);
+		for (; head != tail; ++head)
+		{
+			const struct io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+			completed.emplace_back(
+				std::unique_ptr<Operation>(
+					reinterpret_cast<Operation*>(cqe.user_data)
+				),
+				cqe.res
+			);
+		}
+		__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+		m_numInFlight -= completed.size();
+
+		// resubmit the unfinished ones, before invoking any callback
+		std::vector<std::pair<std::unique_ptr<Operation>, bool> > finished;
+		finished.reserve(completed.size());
+		for (auto& item : completed)
+		{
+			bool hasErrorOccurred = false;
+			if (HandleCompletion(item.first, item.second, hasErrorOccurred))
+			{
+				finished.emplace_back(
+					std::move(item.first),
+					hasErrorOccurred
+				);
+			}
+		}
+
+		if (invokeCallbacks)
+		{
+			std::exception_ptr firstException;
+			for (auto& item : finished)
+			{
+				Operation& op = *item.first;
+				if (!op.m_callback)
+				{
+					continue;
+				}
+				try
+				{
+					op.m_callback(std::move(op.m_buffer), item.second);
+				}
+				catch (...)
+				{
+					if (!firstException)
+					{
+						firstException = std::current_exception();
+					}
+				}
+			}
+			if (firstException)
+			{
+				std::rethrow_exception(firstException);
+			}
+		}
+		return finished.size();
+	}
+
+
+	/**
+	 * @param hasErrorOccurred Set to the result of a finished operation
+	 * @return true if the operation is finished, or false if the remaining
+	 *         part has been resubmitted
+	 */
+	bool HandleCompletion(
+		std::unique_ptr<Operation>& op,
+		int32_t res,
+		bool& hasErrorOccurred
+	)
+	{
+		hasErrorOccurred = (res < 0);
+
+		if (!hasErrorOccurred)
+		{
+			const size_t transferred = static_cast<size_t>(res);
+			op->m_done += transferred;
+
+			const bool isRW =
+				(op->m_opcode == IORING_OP_READ) ||
+				(op->m_opcode == IORING_OP_WRITE);
+			// a short read means the end of the file is reached,
+			// unless the request was split; a short write is always resumed
+			const bool shouldResume =
+				isRW &&
+				(op->m_done < op->m_buffer.size()) &&
+				(transferred > 0) &&
+				(
+					(op->m_opcode == IORING_OP_WRITE) ||
+					(transferred == op->m_reqSize)
+				);
+			if (shouldResume)
+			{
+				Queue(std::move(op));
+				return false;
+			}
+
+			if (op->m_opcode == IORING_OP_READ)
+			{
+				op->m_buffer.resize(op->m_done);
+			}
+			else if (op->m_opcode == IORING_OP_WRITE)
+			{
+				hasErrorOccurred = (op->m_done < op->m_buffer.size());
+			}
+		}
+
+		return true;
+	}
+
+
+	int m_ringFd;
+	struct io_uring_params m_params;
+
+	void* m_sqRing;
+	size_t m_sqRingSize;
+	void* m_cqRing;
+	size_t m_cqRingSize;
+	struct io_uring_sqe* m_sqes;
+	size_t m_sqesSize;
+
+	uint32_t* m_sqHead;
+	uint32_t* m_sqTail;
+	uint32_t m_sqMask;
+	uint32_t* m_sqArray;
+
+	uint32_t* m_cqHead;
+	uint32_t* m_cqTail;
+	uint32_t m_cqMask;
+	struct io_uring_cqe* m_cqes;
+
+	uint32_t m_numQueued;
+	size_t m_numInFlight;
+
+}; // class IOUringEngine
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_SYSCALL_HAS_IO_URING
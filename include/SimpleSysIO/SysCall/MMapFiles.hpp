@@ -0,0 +1,1057 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#if defined(SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM) && !defined(_WIN32)
+
+
+#include <cstring>
+
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <SimpleObjects/RealNumCast.hpp>
+
+#include "../BinaryIOStreamBase.hpp"
+#include "../BytesView.hpp"
+#include "../Exceptions.hpp"
+#include "../Internal/SimpleObjects.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief How writes to a writable memory-mapped file are pushed to the
+ *        storage device when the stream is flushed (or closed)
+ */
+enum class MMapSyncMode : uint8_t
+{
+	/**
+	 * @brief Leave it to the OS; dirty pages are written back eventually
+	 */
+	None,
+	/**
+	 * @brief Schedule the write-back (`msync` with `MS_ASYNC`), without
+	 *        waiting for it
+	 */
+	Async,
+	/**
+	 * @brief Write back and wait for it to complete (`msync` with
+	 *        `MS_SYNC`)
+	 */
+	Sync,
+}; // enum class MMapSyncMode
+
+
+namespace SysCallInternal
+{
+
+/**
+ * @brief Read-only file implementation that maps the entire file into the
+ *        memory, so the page cache is used as the buffer.
+ *        NOTE: the size of the file is determined when it is opened;
+ *        changes to the file size afterwards are not reflected.
+ */
+class MMapRImpl
+{
+public:
+
+	MMapRImpl(const std::string& path) :
+		m_data(nullptr),
+		m_size(0),
+		m_pos(0),
+		m_stat()
+	{
+		int fd = FDOpenImpl::FDOpenS(path, O_RDONLY | O_CLOEXEC);
+
+		try
+		{
+			m_stat = FDCalls::Stat(fd);
+		}
+		catch (...)
+		{
+			::close(fd);
+			throw;
+		}
+		m_size = m_stat.m_size;
+
+		if (m_size > 0)
+		{
+			void* mapped =
+				::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapped == MAP_FAILED)
+			{
+				::close(fd);
+				throw Exception("I/O error while mapping the file at " + path);
+			}
+			m_data = static_cast<const uint8_t*>(mapped);
+		}
+
+		// the mapping stays valid after the descriptor is closed
+		::close(fd);
+	}
+
+
+	~MMapRImpl()
+	{
+		if (m_data != nullptr)
+		{
+			::munmap(const_cast<uint8_t*>(m_data), m_size);
+		}
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		std::ptrdiff_t base = 0;
+		switch (whence)
+		{
+		case SeekWhence::Begin:
+			base = 0;
+			break;
+
+		case SeekWhence::Current:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_pos);
+			break;
+
+		case SeekWhence::End:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_size);
+			break;
+
+		default:
+			throw Exception("Invalid SeekWhence value");
+		}
+
+		if (offset < -base)
+		{
+			throw Exception("Seeking to a position before the beginning");
+		}
+
+		m_pos = static_cast<size_t>(base + offset);
+	}
+
+
+	size_t Tell() const
+	{
+		return m_pos;
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		ConstBytesView view = ReadView(size);
+		if (!view.empty())
+		{
+			std::memcpy(buffer, view.data(), view.size());
+		}
+		return view.size();
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size) const
+	{
+		ConstBytesView view = GetView(offset, size);
+		if (!view.empty())
+		{
+			std::memcpy(buffer, view.data(), view.size());
+		}
+		return view.size();
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		size_t readSize = ReadAtVRaw(m_pos, segments, segCount);
+		m_pos += readSize;
+		return readSize;
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) const
+	{
+		size_t readSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			size_t segReadSize = ReadAtRaw(
+				offset + readSize,
+				segments[i].data(),
+				segments[i].size()
+			);
+			readSize += segReadSize;
+			if (segReadSize < segments[i].size())
+			{
+				break;
+			}
+		}
+		return readSize;
+	}
+
+
+	ConstBytesView ReadView(size_t size)
+	{
+		ConstBytesView view = GetView(m_pos, size);
+		m_pos += view.size();
+		return view;
+	}
+
+
+	ConstBytesView GetView(size_t offset, size_t size) const
+	{
+		if (offset >= m_size)
+		{
+			return ConstBytesView();
+		}
+
+		size_t remain = m_size - offset;
+		return ConstBytesView(
+			m_data + offset,
+			(size < remain ? size : remain)
+		);
+	}
+
+
+	size_t GetMappedSize() const
+	{
+		return m_size;
+	}
+
+
+	/**
+	 * @brief Get the metadata of the file, as it was when it was mapped
+	 */
+	FileStat GetStat() const
+	{
+		return m_stat;
+	}
+
+
+	int GetNativeFD() const
+	{
+		// the descriptor is closed once the file is mapped
+		return -1;
+	}
+
+
+	/**
+	 * @brief Advise the OS about how the mapped memory is going to be
+	 *        accessed; failures are ignored, since it is only a hint
+	 */
+	void SetAccessHint(AccessHint hint)
+	{
+		if (m_data == nullptr)
+		{
+			return;
+		}
+
+		int advice = POSIX_MADV_NORMAL;
+		switch (hint)
+		{
+		case AccessHint::Sequential:
+			advice = POSIX_MADV_SEQUENTIAL;
+			break;
+
+		case AccessHint::Random:
+			advice = POSIX_MADV_RANDOM;
+			break;
+
+		case AccessHint::WillNeed:
+			advice = POSIX_MADV_WILLNEED;
+			break;
+
+		case AccessHint::DontNeed:
+			advice = POSIX_MADV_DONTNEED;
+			break;
+
+		case AccessHint::Normal:
+		default:
+			break;
+		}
+
+		::posix_madvise(const_cast<uint8_t*>(m_data), m_size, advice);
+	}
+
+
+private:
+
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_pos;
+	FileStat m_stat;
+
+}; // class MMapRImpl
+
+
+/**
+ * @brief Read-write file implementation that maps the file into the memory,
+ *        so reads and writes are plain memory accesses.
+ *        The file (and the mapping) grows in steps of `growthStep` bytes as
+ *        writes pass the end of the mapping, so most writes do not need any
+ *        system call; the file is truncated back to its logical size when
+ *        it is closed.
+ *        NOTE: while the file is opened, it may be padded on the disk, and
+ *        the logical size is tracked by this object, so the file should not
+ *        be modified by others.
+ */
+class MMapRWImpl
+{
+public: // static members:
+
+	static constexpr size_t sk_defGrowthStep = 16 * 1024 * 1024;
+
+public:
+
+	MMapRWImpl(
+		const std::string& path,
+		const std::string& mode,
+		size_t growthStep,
+		MMapSyncMode syncMode
+	) :
+		MMapRWImpl(
+			path,
+			FDOpenImpl::ModeToFlags(mode),
+			growthStep,
+			syncMode
+		)
+	{}
+
+
+	~MMapRWImpl()
+	{
+		// nothing we can do if any of these fails in the destructor
+		try
+		{
+			SyncRange(0, m_size, m_syncMode);
+		}
+		catch (...)
+		{}
+		Unmap();
+		int res = ::ftruncate(m_fd, static_cast<off_t>(m_size));
+		(void)res;
+		::close(m_fd);
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		std::ptrdiff_t base = 0;
+		switch (whence)
+		{
+		case SeekWhence::Begin:
+			base = 0;
+			break;
+
+		case SeekWhence::Current:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_pos);
+			break;
+
+		case SeekWhence::End:
+			base = Internal::Obj::RealNumCast<std::ptrdiff_t>(m_size);
+			break;
+
+		default:
+			throw Exception("Invalid SeekWhence value");
+		}
+
+		if (offset < -base)
+		{
+			throw Exception("Seeking to a position before the beginning");
+		}
+
+		m_pos = static_cast<size_t>(base + offset);
+	}
+
+
+	size_t Tell() const
+	{
+		return m_pos;
+	}
+
+
+	/**
+	 * @brief Push the written data to the storage device, according to the
+	 *        sync mode
+	 */
+	void Flush()
+	{
+		SyncRange(0, m_size, m_syncMode);
+	}
+
+
+	size_t ReadBytesRaw(void* buffer, size_t size)
+	{
+		size_t readSize = ReadAtRaw(m_pos, buffer, size);
+		m_pos += readSize;
+		return readSize;
+	}
+
+
+	size_t ReadAtRaw(size_t offset, void* buffer, size_t size) const
+	{
+		ConstBytesView view = GetView(offset, size);
+		if (!view.empty())
+		{
+			std::memcpy(buffer, view.data(), view.size());
+		}
+		return view.size();
+	}
+
+
+	size_t ReadBytesVRaw(const MutableBytesView* segments, size_t segCount)
+	{
+		size_t readSize = ReadAtVRaw(m_pos, segments, segCount);
+		m_pos += readSize;
+		return readSize;
+	}
+
+
+	size_t ReadAtVRaw(
+		size_t offset,
+		const MutableBytesView* segments,
+		size_t segCount
+	) const
+	{
+		size_t readSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			size_t segReadSize = ReadAtRaw(
+				offset + readSize,
+				segments[i].data(),
+				segments[i].size()
+			);
+			readSize += segReadSize;
+			if (segReadSize < segments[i].size())
+			{
+				break;
+			}
+		}
+		return readSize;
+	}
+
+
+	void WriteBytesRaw(const void* buffer, size_t size)
+	{
+		MutableBytesView view = WriteView(size);
+		if (size > 0)
+		{
+			std::memcpy(view.data(), buffer, size);
+		}
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		if (size > 0)
+		{
+			std::memcpy(GetWritePtr(offset, size), buffer, size);
+		}
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		if (m_isAppend)
+		{
+			m_pos = m_size;
+		}
+		size_t offset = m_pos;
+		WriteAtVRaw(offset, segments, segCount);
+		m_pos = offset + TotalSize(segments, segCount);
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		// grow once for all segments
+		size_t totalSize = TotalSize(segments, segCount);
+		if (totalSize == 0)
+		{
+			return;
+		}
+		uint8_t* dest = GetWritePtr(offset, totalSize);
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			if (!segments[i].empty())
+			{
+				std::memcpy(dest, segments[i].data(), segments[i].size());
+				dest += segments[i].size();
+			}
+		}
+	}
+
+
+	ConstBytesView GetView(size_t offset, size_t size) const
+	{
+		if (offset >= m_size)
+		{
+			return ConstBytesView();
+		}
+
+		size_t remain = m_size - offset;
+		return ConstBytesView(
+			m_data + offset,
+			(size < remain ? size : remain)
+		);
+	}
+
+
+	/**
+	 * @brief Get a writable pointer to `size` bytes at `offset`, growing the
+	 *        file if needed; the logical size of the file is extended to
+	 *        cover the range
+	 */
+	uint8_t* GetWritePtr(size_t offset, size_t size)
+	{
+		size_t end = offset + size;
+		Reserve(end);
+		if (end > m_size)
+		{
+			m_size = end;
+		}
+		return m_data + offset;
+	}
+
+
+	/**
+	 * @brief Get a writable view of `size` bytes at the current position
+	 *        (or at the end, in the append mode), and advance the position
+	 *        past it
+	 */
+	MutableBytesView WriteView(size_t size)
+	{
+		if (m_isAppend)
+		{
+			m_pos = m_size;
+		}
+		uint8_t* ptr = GetWritePtr(m_pos, size);
+		m_pos += size;
+		return MutableBytesView(ptr, size);
+	}
+
+
+	/**
+	 * @brief Make sure the mapping covers at least `capacity` bytes, without
+	 *        changing the logical size of the file
+	 */
+	void Reserve(size_t capacity)
+	{
+		if (capacity <= m_capacity)
+		{
+			return;
+		}
+
+		size_t newCapacity =
+			((capacity + m_growthStep - 1) / m_growthStep) * m_growthStep;
+
+		int res = ::ftruncate(
+			m_fd,
+			Internal::Obj::RealNumCast<off_t>(newCapacity)
+		);
+		if (res != 0)
+		{
+			throw Exception("I/O error while extending the file");
+		}
+
+		void* mapped = MAP_FAILED;
+		if (m_data == nullptr)
+		{
+			mapped = ::mmap(
+				nullptr,
+				newCapacity,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED,
+				m_fd,
+				0
+			);
+		}
+		else
+		{
+#if defined(__linux__)
+			mapped = ::mremap(m_data, m_capacity, newCapacity, MREMAP_MAYMOVE);
+#else
+			// the new mapping is set up before the old one is released, so
+			// the object is left untouched if it fails; both are shared
+			// mappings of the same file, so they see the same data
+			mapped = ::mmap(
+				nullptr,
+				newCapacity,
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED,
+				m_fd,
+				0
+			);
+			if (mapped != MAP_FAILED)
+			{
+				Unmap();
+			}
+#endif // defined(__linux__)
+		}
+		if (mapped == MAP_FAILED)
+		{
+			throw Exception("I/O error while mapping the file");
+		}
+
+		m_data = static_cast<uint8_t*>(mapped);
+		m_capacity = newCapacity;
+	}
+
+
+	/**
+	 * @brief Push the data in the given range to the storage device
+	 */
+	void SyncRange(size_t offset, size_t size, MMapSyncMode mode)
+	{
+		if ((mode == MMapSyncMode::None) ||
+			(m_data == nullptr) ||
+			(offset >= m_size))
+		{
+			return;
+		}
+		if (size > m_size - offset)
+		{
+			size = m_size - offset;
+		}
+
+		// `msync` requires the address to be aligned to the page size
+		size_t begin = (offset / m_pageSize) * m_pageSize;
+		int res = ::msync(
+			m_data + begin,
+			size + (offset - begin),
+			(mode == MMapSyncMode::Sync) ? MS_SYNC : MS_ASYNC
+		);
+		if (res != 0)
+		{
+			throw Exception("I/O error while syncing the mapped file");
+		}
+	}
+
+
+	MMapSyncMode GetSyncMode() const
+	{
+		return m_syncMode;
+	}
+
+
+	void SetSyncMode(MMapSyncMode syncMode)
+	{
+		m_syncMode = syncMode;
+	}
+
+
+	size_t GetGrowthStep() const
+	{
+		return m_growthStep;
+	}
+
+
+	FileStat GetStat() const
+	{
+		FileStat res = FDCalls::Stat(m_fd);
+		// the file may still be padded on the disk
+		res.m_size = m_size;
+		return res;
+	}
+
+
+	int GetNativeFD() const
+	{
+		// the logical size is tracked here, and the file may be padded on
+		// the disk, so the descriptor cannot be used by others directly
+		return -1;
+	}
+
+
+private:
+
+	MMapRWImpl(
+		const std::string& path,
+		int flags,
+		size_t growthStep,
+		MMapSyncMode syncMode
+	) :
+		// a shared writable mapping needs the file to be readable as well;
+		// the append mode is emulated, since the writes do not go through
+		// the descriptor
+		m_fd(
+			FDOpenImpl::FDOpenS(
+				path,
+				(flags & ~(O_ACCMODE | O_APPEND)) | O_RDWR
+			)
+		),
+		m_data(nullptr),
+		m_size(0),
+		m_capacity(0),
+		m_pos(0),
+		m_pageSize(static_cast<size_t>(::sysconf(_SC_PAGESIZE))),
+		m_growthStep(growthStep),
+		m_syncMode(syncMode),
+		m_isAppend((flags & O_APPEND) != 0)
+	{
+		try
+		{
+			// the step has to be a multiple of the page size, so the file
+			// never ends in the middle of a mapped page
+			if (m_growthStep < m_pageSize)
+			{
+				m_growthStep = m_pageSize;
+			}
+			m_growthStep = ((m_growthStep + m_pageSize - 1) / m_pageSize) *
+				m_pageSize;
+
+			m_size = FDCalls::Stat(m_fd).m_size;
+			Reserve(m_size);
+		}
+		catch (...)
+		{
+			Unmap();
+			::close(m_fd);
+			throw;
+		}
+
+		if (m_isAppend)
+		{
+			m_pos = m_size;
+		}
+	}
+
+
+	static size_t TotalSize(const ConstBytesView* segments, size_t segCount)
+	{
+		size_t totalSize = 0;
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			totalSize += segments[i].size();
+		}
+		return totalSize;
+	}
+
+
+	void Unmap()
+	{
+		if (m_data != nullptr)
+		{
+			::munmap(m_data, m_capacity);
+			m_data = nullptr;
+			m_capacity = 0;
+		}
+	}
+
+
+	int m_fd;
+	uint8_t* m_data;
+	size_t m_size;
+	size_t m_capacity;
+	size_t m_pos;
+	size_t m_pageSize;
+	size_t m_growthStep;
+	MMapSyncMode m_syncMode;
+	bool m_isAppend;
+
+}; // class MMapRWImpl
+
+} // namespace SysCallInternal
+
+
+/**
+ * @brief Read-only binary stream backed by a memory-mapped file.
+ *        In addition to the `RBinaryIOSBase` interface, it provides views
+ *        into the mapped memory, so data can be accessed without being
+ *        copied.
+ *        NOTE: views returned are only valid as long as this stream is alive.
+ */
+class MMapRBinaryIOS :
+	public RBinaryIOSWrapper<SysCallInternal::MMapRImpl>
+{
+public: // static members:
+
+	using ImplType = SysCallInternal::MMapRImpl;
+	using Base = RBinaryIOSWrapper<ImplType>;
+
+public:
+
+	MMapRBinaryIOS(std::unique_ptr<ImplType> impl) :
+		Base(std::move(impl))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~MMapRBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Get a view of up to `count` bytes starting from the current
+	 *        position, and advance the position by the size of the view
+	 *
+	 * @param count The maximum number of bytes to be viewed
+	 * @return The view; it may be shorter than `count` if the end of the
+	 *         file is reached
+	 */
+	ConstBytesView ReadView(size_t count)
+	{
+		return GetImpl().ReadView(count);
+	}
+
+
+	/**
+	 * @brief Get a view of all the bytes from the current position till the
+	 *        end of the file, and advance the position to the end
+	 */
+	ConstBytesView ReadView()
+	{
+		return GetImpl().ReadView(GetImpl().GetMappedSize());
+	}
+
+
+	/**
+	 * @brief Get a view of up to `count` bytes starting from the given
+	 *        offset; the current position is not affected
+	 */
+	ConstBytesView GetView(size_t offset, size_t count) const
+	{
+		return GetImpl().GetView(offset, count);
+	}
+
+
+	/**
+	 * @brief Get a view of the entire file
+	 */
+	ConstBytesView GetView() const
+	{
+		return GetImpl().GetView(0, GetImpl().GetMappedSize());
+	}
+
+}; // class MMapRBinaryIOS
+
+
+/**
+ * @brief Read-write binary stream backed by a memory-mapped file.
+ *        In addition to the `RWBinaryIOSBase` interface, it provides
+ *        pointers and views into the mapped memory, so data can be written
+ *        in place, without being copied or going through system calls.
+ *        NOTE: pointers and views returned are invalidated when the file
+ *        grows (i.e., by writes past the mapped size, or `Reserve()`), and
+ *        when this stream is destroyed.
+ */
+class MMapRWBinaryIOS :
+	public RWBinaryIOSWrapper<SysCallInternal::MMapRWImpl>
+{
+public: // static members:
+
+	using ImplType = SysCallInternal::MMapRWImpl;
+	using Base = RWBinaryIOSWrapper<ImplType>;
+
+public:
+
+	MMapRWBinaryIOS(std::unique_ptr<ImplType> impl) :
+		Base(std::move(impl))
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~MMapRWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	/**
+	 * @brief Get a pointer to `count` writable bytes at the given offset;
+	 *        the file grows if needed, and its size is extended to cover
+	 *        the range. The current position is not affected.
+	 */
+	uint8_t* GetWritePtr(size_t offset, size_t count)
+	{
+		return GetImpl().GetWritePtr(offset, count);
+	}
+
+
+	/**
+	 * @brief Get a view of `count` writable bytes at the current position,
+	 *        and advance the position past it; the file grows if needed
+	 */
+	MutableBytesView WriteView(size_t count)
+	{
+		return GetImpl().WriteView(count);
+	}
+
+
+	/**
+	 * @brief Get a view of up to `count` bytes starting from the given
+	 *        offset; the current position is not affected
+	 */
+	ConstBytesView GetView(size_t offset, size_t count) const
+	{
+		return GetImpl().GetView(offset, count);
+	}
+
+
+	/**
+	 * @brief Grow the mapping (and the file on the disk) to at least
+	 *        `capacity` bytes in advance; the size of the file is not
+	 *        affected
+	 */
+	void Reserve(size_t capacity)
+	{
+		GetImpl().Reserve(capacity);
+	}
+
+
+	/**
+	 * @brief Push the data in the given range to the storage device, with
+	 *        the given mode, regardless of the mode used by `Flush()`
+	 */
+	void SyncRange(size_t offset, size_t count, MMapSyncMode mode)
+	{
+		GetImpl().SyncRange(offset, count, mode);
+	}
+
+
+	MMapSyncMode GetSyncMode() const
+	{
+		return GetImpl().GetSyncMode();
+	}
+
+
+	/**
+	 * @brief Set how `Flush()`, and closing the stream, push the data to
+	 *        the storage device
+	 */
+	void SetSyncMode(MMapSyncMode syncMode)
+	{
+		GetImpl().SetSyncMode(syncMode);
+	}
+
+}; // class MMapRWBinaryIOS
+
+
+struct MMapRBinaryFile
+{
+	using ImplType = SysCallInternal::MMapRImpl;
+	using WrapperType = MMapRBinaryIOS;
+	using RetType = std::unique_ptr<WrapperType>;
+
+	static RetType Open(
+		const std::string& path,
+		AccessHint hint = AccessHint::Normal
+	)
+	{
+		auto impl =
+			Internal::Obj::Internal::make_unique<ImplType>(path);
+		if (hint != AccessHint::Normal)
+		{
+			impl->SetAccessHint(hint);
+		}
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+}; // struct MMapRBinaryFile
+
+
+/**
+ * @brief Open files for reading and writing through a writable memory
+ *        mapping.
+ *
+ * @param growthStep The file grows in multiples of this size (rounded up
+ *                   to the page size) as writes pass the end of the mapping
+ * @param syncMode How `Flush()`, and closing the stream, push the data to
+ *                 the storage device
+ */
+struct MMapRWBinaryFile
+{
+	using ImplType = SysCallInternal::MMapRWImpl;
+	using WrapperType = MMapRWBinaryIOS;
+	using RetType = std::unique_ptr<WrapperType>;
+
+	static RetType Create(
+		const std::string& path,
+		size_t growthStep = ImplType::sk_defGrowthStep,
+		MMapSyncMode syncMode = MMapSyncMode::None
+	)
+	{
+		return OpenImpl(path, "wb+", growthStep, syncMode);
+	}
+
+	/**
+	 * @brief Open an existing file, keeping its content
+	 */
+	static RetType Open(
+		const std::string& path,
+		size_t growthStep = ImplType::sk_defGrowthStep,
+		MMapSyncMode syncMode = MMapSyncMode::None
+	)
+	{
+		return OpenImpl(path, "rb+", growthStep, syncMode);
+	}
+
+	static RetType Append(
+		const std::string& path,
+		size_t growthStep = ImplType::sk_defGrowthStep,
+		MMapSyncMode syncMode = MMapSyncMode::None
+	)
+	{
+		return OpenImpl(path, "ab+", growthStep, syncMode);
+	}
+
+private:
+
+	static RetType OpenImpl(
+		const std::string& path,
+		const std::string& mode,
+		size_t growthStep,
+		MMapSyncMode syncMode
+	)
+	{
+		auto impl = Internal::Obj::Internal::make_unique<ImplType>(
+			path,
+			mode,
+			growthStep,
+			syncMode
+		);
+
+		return
+			Internal::Obj::Internal::make_unique<WrapperType>(
+				std::move(impl)
+			);
+	}
+}; // struct MMapRWBinaryFile
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM && !_WIN32
@@ -0,0 +1,67 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#ifdef SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
+
+
+#include <memory>
+#include <string>
+
+#include "../Internal/SimpleObjects.hpp"
+#include "../RecordFile.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief Open record files (see `RecordFileFormat`).
+ *        The buffered file streams are used, since records are usually
+ *        small, and they are read sequentially most of the time; positional
+ *        reads go to the file directly.
+ */
+struct RecordFile
+{
+	using WriterType = RecordFileWriter;
+	using ReaderType = RecordFileReader;
+
+	static std::unique_ptr<WriterType> Create(
+		const std::string& path,
+		size_t indexInterval = WriterType::sk_defIndexInterval
+	)
+	{
+		return Internal::Obj::Internal::make_unique<WriterType>(
+			WBinaryFile::Create(path),
+			indexInterval
+		);
+	}
+
+	static std::unique_ptr<ReaderType> Open(const std::string& path)
+	{
+		return Internal::Obj::Internal::make_unique<ReaderType>(
+			RBinaryFile::Open(path)
+		);
+	}
+}; // struct RecordFile
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
@@ -14,10 +14,31 @@
 
 #include "../StreamSocketBase.hpp"
 
+#include <cerrno>
+
+#include <array>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#if defined(__linux__)
+#	include <fcntl.h>
+#	include <sys/sendfile.h>
+#	include <unistd.h>
+#endif // defined(__linux__)
+
+#include "../BinaryIOStreamBase.hpp"
+#include "../Exceptions.hpp"
+#include "AlignedBufferPool.hpp"
 
 
 #ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
@@ -38,6 +59,80 @@ public: // static members:
 	friend class TCPAcceptor;
 
 
+	/**
+	 * @brief The callback for `AsyncSendFile`; the first argument is the
+	 *        number of bytes sent, and the second one indicates whether an
+	 *        error has occurred
+	 */
+	using AsyncSendFileCallback = std::function<void(size_t, bool)>;
+
+
+	/**
+	 * @brief The callback for `AsyncRecvPooled`; the arguments are the
+	 *        buffer, the number of bytes received into it, and whether an
+	 *        error has occurred.
+	 *        The buffer goes back to the pool when it is destroyed, so it
+	 *        can be kept for as long as needed.
+	 */
+	using AsyncRecvPooledCallback =
+		std::function<void(AlignedBuffer, size_t, bool)>;
+
+
+	/**
+	 * @brief The maximum number of segments sent by one gathered write in
+	 *        `SendBytesV`; more segments are sent by more writes
+	 */
+	static constexpr size_t sk_maxSendVSegments = 16;
+
+
+	/**
+	 * @brief The maximum number of queued sends coalesced into one gathered
+	 *        write by `AsyncSendRaw`
+	 */
+	static constexpr size_t sk_maxSendBatch = 64;
+
+
+	/**
+	 * @brief The size of the buffers in the receive buffer pool created by
+	 *        default
+	 */
+	static constexpr size_t sk_defRecvPoolBufferSize = 64 * 1024;
+
+
+	/**
+	 * @brief The alignment of the buffers in the receive buffer pool
+	 *        created by default; a cache line
+	 */
+	static constexpr size_t sk_defRecvPoolAlignment = 64;
+
+
+	/**
+	 * @brief The maximum number of released buffers kept by the receive
+	 *        buffer pool created by default
+	 */
+	static constexpr size_t sk_defRecvPoolMaxCached = 4;
+
+
+	/**
+	 * @brief The size of the buffer used to send a file when it has to go
+	 *        through the user space
+	 */
+	static constexpr size_t sk_sendFileBufferSize = 64 * 1024;
+
+
+	/**
+	 * @brief The maximum number of bytes passed to one `sendfile` call
+	 */
+	static constexpr size_t sk_maxSendFileChunk = 1024 * 1024 * 1024;
+
+
+	/**
+	 * @brief The capacity requested for the pipe used by `RecvToFile`, which
+	 *        is also the maximum number of bytes moved by one `splice` call
+	 */
+	static constexpr size_t sk_recvToFilePipeSize = 1024 * 1024;
+
+
 	/**
 	 * @brief create a TCP socket that is neither opened, connected to any remote
 	 *        endpoint nor bound (accepted) to any local endpoint
@@ -135,6 +230,11 @@ public: // static members:
 	}
 
 
+	/**
+	 * @brief The completion handler of `AsyncRecvRaw`; it's moved into the
+	 *        operation, and moving the vector does not move its data, so no
+	 *        separate shared state is needed
+	 */
 	struct AsyncRecvHandler
 	{
 		std::vector<uint8_t> m_buffer;
@@ -148,27 +248,308 @@ public: // static members:
 			m_callback(std::move(callback))
 		{}
 
+		AsyncRecvHandler(AsyncRecvHandler&&) = default;
+
 		~AsyncRecvHandler() = default;
 
-		static void Handler(
-			std::shared_ptr<AsyncRecvHandler> handler,
+		void operator()(
 			const boost::system::error_code& error,
 			size_t bytesTransferred
 		)
 		{
-			handler->m_buffer.resize(bytesTransferred);
+			m_buffer.resize(bytesTransferred);
 			if (!error)
 			{
-				handler->m_callback(std::move(handler->m_buffer), false);
+				m_callback(std::move(m_buffer), false);
 			}
 			else
 			{
-				handler->m_callback(std::move(handler->m_buffer), true);
+				m_callback(std::move(m_buffer), true);
 			}
 		}
 	}; // struct AsyncRecvHandler
 
 
+	/**
+	 * @brief The completion handler of `AsyncRecvRawUntilComplete`
+	 */
+	struct AsyncRecvUntilCompleteHandler
+	{
+		std::vector<uint8_t> m_buffer;
+		AsyncRecvCallback m_callback;
+
+		AsyncRecvUntilCompleteHandler(
+			size_t expSize,
+			AsyncRecvCallback callback
+		) :
+			m_buffer(expSize),
+			m_callback(std::move(callback))
+		{}
+
+		AsyncRecvUntilCompleteHandler(
+			AsyncRecvUntilCompleteHandler&&
+		) = default;
+
+		~AsyncRecvUntilCompleteHandler() = default;
+
+		void operator()(
+			const boost::system::error_code& error,
+			size_t /* bytesTransferred */
+		)
+		{
+			if (!error)
+			{
+				m_callback(std::move(m_buffer), false);
+			}
+			else
+			{
+				m_callback(std::vector<uint8_t>(), true);
+			}
+		}
+	}; // struct AsyncRecvUntilCompleteHandler
+
+
+	/**
+	 * @brief The completion handler of the gathered writes issued by
+	 *        `AsyncSendRaw`
+	 */
+	struct AsyncSendQueueHandler
+	{
+		TCPSocket* m_socket;
+
+		void operator()(
+			const boost::system::error_code& error,
+			size_t bytesTransferred
+		)
+		{
+			m_socket->OnSendBatchDone(error, bytesTransferred);
+		}
+	}; // struct AsyncSendQueueHandler
+
+
+	/**
+	 * @brief The completion handler of `AsyncRecvPooled`
+	 */
+	struct AsyncRecvPooledHandler
+	{
+		AlignedBuffer m_buffer;
+		AsyncRecvPooledCallback m_callback;
+
+		AsyncRecvPooledHandler(
+			AlignedBuffer buffer,
+			AsyncRecvPooledCallback callback
+		) :
+			m_buffer(std::move(buffer)),
+			m_callback(std::move(callback))
+		{}
+
+		AsyncRecvPooledHandler(AsyncRecvPooledHandler&&) = default;
+
+		~AsyncRecvPooledHandler() = default;
+
+		void operator()(
+			const boost::system::error_code& error,
+			size_t bytesTransferred
+		)
+		{
+			m_callback(
+				std::move(m_buffer),
+				bytesTransferred,
+				static_cast<bool>(error)
+			);
+		}
+	}; // struct AsyncRecvPooledHandler
+
+
+	/**
+	 * @brief Put the socket into the non-blocking mode while the guard is
+	 *        alive, so `sendfile` and `splice` report a full (or an empty)
+	 *        buffer rather than blocking the thread (asio keeps blocking
+	 *        semantics for its synchronous operations regardless); the
+	 *        previous mode is restored when the guard is destroyed
+	 */
+	struct NativeNonBlockingGuard
+	{
+		boost::asio::ip::tcp::socket* m_socket;
+		bool m_isChanged;
+
+		NativeNonBlockingGuard(
+			boost::asio::ip::tcp::socket& socket,
+			bool isNeeded
+		) :
+			m_socket(&socket),
+			m_isChanged(false)
+		{
+			if (isNeeded && !m_socket->native_non_blocking())
+			{
+				m_socket->native_non_blocking(true);
+				m_isChanged = true;
+			}
+		}
+
+		NativeNonBlockingGuard(const NativeNonBlockingGuard&) = delete;
+
+		~NativeNonBlockingGuard()
+		{
+			if (m_isChanged)
+			{
+				// the destructor must not throw; a socket that fails to be
+				// restored is most likely closed already
+				boost::system::error_code error;
+				m_socket->native_non_blocking(false, error);
+			}
+		}
+
+		NativeNonBlockingGuard& operator=(
+			const NativeNonBlockingGuard&
+		) = delete;
+	}; // struct NativeNonBlockingGuard
+
+
+	struct AsyncSendFileHandler :
+		public std::enable_shared_from_this<AsyncSendFileHandler>
+	{
+		TCPSocket* m_socket;
+		RBinaryIOSBase* m_file;
+		int m_fileFD;
+		NativeNonBlockingGuard m_nonBlocking;
+		size_t m_offset;
+		size_t m_remaining;
+		size_t m_sent;
+		std::vector<uint8_t> m_buffer;
+		AsyncSendFileCallback m_callback;
+
+		AsyncSendFileHandler(
+			TCPSocket& socket,
+			RBinaryIOSBase& file,
+			size_t offset,
+			size_t length,
+			AsyncSendFileCallback callback
+		) :
+			m_socket(&socket),
+			m_file(&file),
+			m_fileFD(socket.KernelSendFD(file)),
+			m_nonBlocking(socket.m_socket, m_fileFD >= 0),
+			m_offset(offset),
+			m_remaining(length),
+			m_sent(0),
+			m_buffer(),
+			m_callback(std::move(callback))
+		{}
+
+		~AsyncSendFileHandler() = default;
+
+		/**
+		 * @brief Send as much as possible without blocking, and then either
+		 *        wait for the socket to be writable again, or report the
+		 *        result
+		 */
+		void Continue()
+		{
+			std::shared_ptr<AsyncSendFileHandler> self = shared_from_this();
+			try
+			{
+				while (m_remaining > 0)
+				{
+					if (m_fileFD >= 0)
+					{
+						bool isBlocked = false;
+						size_t sent = m_socket->KernelSendSome(
+							m_fileFD, m_offset, m_remaining, isBlocked
+						);
+						if (isBlocked)
+						{
+							m_socket->m_socket.async_wait(
+								boost::asio::ip::tcp::socket::wait_write,
+								[self](const boost::system::error_code& error)
+								{
+									if (error)
+									{
+										self->Finish(true);
+									}
+									else
+									{
+										self->Continue();
+									}
+								}
+							);
+							return;
+						}
+						if (sent == 0)
+						{
+							// the kernel path is not available (or the file
+							// ended); let the user-space path decide
+							m_fileFD = -1;
+							continue;
+						}
+						Advance(sent);
+					}
+					else
+					{
+						if (m_buffer.empty())
+						{
+							m_buffer.resize(
+								m_remaining < sk_sendFileBufferSize ?
+									m_remaining : sk_sendFileBufferSize
+							);
+						}
+						size_t readSize = Internal::BinaryIOSRaw::ReadAt(
+							*m_file,
+							m_offset,
+							m_buffer.data(),
+							(m_remaining < m_buffer.size() ?
+								m_remaining : m_buffer.size())
+						);
+						if (readSize == 0)
+						{
+							// the file is shorter than expected
+							break;
+						}
+						boost::asio::async_write(
+							m_socket->m_socket,
+							boost::asio::buffer(m_buffer.data(), readSize),
+							[self](
+								const boost::system::error_code& error,
+								size_t bytesTransferred
+							)
+							{
+								self->Advance(bytesTransferred);
+								if (error)
+								{
+									self->Finish(true);
+								}
+								else
+								{
+									self->Continue();
+								}
+							}
+						);
+						return;
+					}
+				}
+			}
+			catch (...)
+			{
+				Finish(true);
+				return;
+			}
+			Finish(false);
+		}
+
+		void Advance(size_t size)
+		{
+			m_offset += size;
+			m_remaining -= size;
+			m_sent += size;
+		}
+
+		void Finish(bool hasErrorOccurred)
+		{
+			m_callback(m_sent, hasErrorOccurred);
+		}
+	}; // struct AsyncSendFileHandler
+
+
 public:
 
 
@@ -190,13 +571,249 @@ public:
 	}
 
 
+	/**
+	 * @brief Send `length` bytes of the file, starting from `offset`, to the
+	 *        peer; the current position of the file is neither used nor
+	 *        moved.
+	 *        If the stream is backed by a file descriptor, the data is moved
+	 *        by the kernel (`sendfile`), without being copied to the user
+	 *        space; otherwise, it is read and sent through a buffer.
+	 *        NOTE: This function will block until all data is sent, the end
+	 *        of the file is reached, or an error occurs.
+	 *        NOTE: data buffered by a writable stream must be flushed first.
+	 *
+	 * @return The number of bytes sent; it is less than `length` only if
+	 *         the end of the file is reached
+	 */
+	size_t SendFile(RBinaryIOSBase& file, size_t offset, size_t length)
+	{
+		length = ClampFileRange(file, offset, length);
+
+		size_t sent = 0;
+		int fileFD = KernelSendFD(file);
+		NativeNonBlockingGuard nonBlocking(m_socket, fileFD >= 0);
+		while ((fileFD >= 0) && (sent < length))
+		{
+			bool isBlocked = false;
+			size_t sentSome = KernelSendSome(
+				fileFD, offset + sent, length - sent, isBlocked
+			);
+			if (isBlocked)
+			{
+				m_socket.wait(boost::asio::ip::tcp::socket::wait_write);
+			}
+			else if (sentSome == 0)
+			{
+				break;
+			}
+			sent += sentSome;
+		}
+
+		if (sent < length)
+		{
+			std::vector<uint8_t> buffer(
+				(length - sent) < sk_sendFileBufferSize ?
+					(length - sent) : sk_sendFileBufferSize
+			);
+			while (sent < length)
+			{
+				size_t readSize = Internal::BinaryIOSRaw::ReadAt(
+					file,
+					offset + sent,
+					buffer.data(),
+					((length - sent) < buffer.size() ?
+						(length - sent) : buffer.size())
+				);
+				if (readSize == 0)
+				{
+					break;
+				}
+				SendRawUntilComplete(buffer.data(), readSize);
+				sent += readSize;
+			}
+		}
+
+		return sent;
+	}
+
+
+	/**
+	 * @brief Send the entire file to the peer
+	 */
+	size_t SendFile(RBinaryIOSBase& file)
+	{
+		return SendFile(file, 0, file.GetFileSize());
+	}
+
+
+	/**
+	 * @brief Receive exactly `length` bytes from the peer, and write them to
+	 *        the file at its current position, which is moved forward
+	 *        accordingly.
+	 *        If the stream is backed by a file descriptor, the data is
+	 *        spliced from the socket, through a pipe, into the file by the
+	 *        kernel, without being copied to the user space; otherwise (or
+	 *        if the file does not support `splice`, e.g., it's opened in the
+	 *        append mode), it is received into a buffer and written.
+	 *        NOTE: This function will block until all data is received, or
+	 *        an error occurs.
+	 *
+	 * @exception boost::wrapexcept<boost::system::system_error> Thrown when
+	 *            the connection is closed before all data is received
+	 *
+	 * @return The number of bytes received, which is always `length`
+	 */
+	size_t RecvToFile(WBinaryIOSBase& file, size_t length)
+	{
+		file.Flush();
+
+		size_t received = 0;
+		std::vector<uint8_t> buffer;
+
+		int fileFD = KernelRecvFD(file);
+		if (fileFD >= 0)
+		{
+			NativeNonBlockingGuard nonBlocking(m_socket, true);
+			size_t startPos = file.Tell();
+			received = KernelRecvToFile(fileFD, startPos, length, buffer);
+			file.Seek(static_cast<std::ptrdiff_t>(startPos + received));
+
+			// bytes left in the pipe, when the file turned out not to
+			// support `splice`
+			if (buffer.size() > 0)
+			{
+				file.WriteBytes(buffer);
+				received += buffer.size();
+			}
+		}
+
+		if (received < length)
+		{
+			buffer.resize(
+				(length - received) < sk_sendFileBufferSize ?
+					(length - received) : sk_sendFileBufferSize
+			);
+			while (received < length)
+			{
+				size_t recvSize = RecvRaw(
+					buffer.data(),
+					((length - received) < buffer.size() ?
+						(length - received) : buffer.size())
+				);
+				Internal::BinaryIOSRaw::Write(file, buffer.data(), recvSize);
+				received += recvSize;
+			}
+		}
+
+		return received;
+	}
+
+
+	/**
+	 * @brief Set the pool from which `AsyncRecvPooled` takes its buffers;
+	 *        the pool is thread-safe, so it can be shared by all sockets on
+	 *        the same io_service (or any number of io_services).
+	 *        Buffers already given out are not affected.
+	 */
+	void SetRecvBufferPool(std::shared_ptr<AlignedBufferPool> pool)
+	{
+		m_recvPool = std::move(pool);
+	}
+
+
+	/**
+	 * @brief Get the pool used by `AsyncRecvPooled`; if none has been set,
+	 *        a pool owned by this socket is created with the default
+	 *        settings
+	 */
+	const std::shared_ptr<AlignedBufferPool>& GetRecvBufferPool()
+	{
+		if (m_recvPool == nullptr)
+		{
+			m_recvPool = AlignedBufferPool::Create(
+				sk_defRecvPoolBufferSize,
+				sk_defRecvPoolAlignment,
+				sk_defRecvPoolMaxCached
+			);
+		}
+		return m_recvPool;
+	}
+
+
+	/**
+	 * @brief Receive some data asynchronously into a buffer taken from the
+	 *        receive buffer pool (see `GetRecvBufferPool`), which is at most
+	 *        as much as the size of the pool's buffers.
+	 *        Unlike `AsyncRecvRaw`, the buffer is neither allocated nor
+	 *        zero-filled for each receive: the callback gets the buffer
+	 *        itself, and it goes back to the pool once the callback (or
+	 *        whoever the callback hands it to) destroys it.
+	 *        NOTE: only the first `bytesReceived` bytes of the buffer are
+	 *        meaningful; the rest are not initialized.
+	 */
+	void AsyncRecvPooled(AsyncRecvPooledCallback callback)
+	{
+		AsyncRecvPooledHandler handler(
+			GetRecvBufferPool()->Acquire(),
+			std::move(callback)
+		);
+		auto buffer = boost::asio::buffer(
+			handler.m_buffer.data(),
+			handler.m_buffer.size()
+		);
+
+		m_socket.async_receive(buffer, std::move(handler));
+	}
+
+
+	/**
+	 * @brief The asynchronous version of `SendFile`, driven by the
+	 *        io_service of this socket; `callback` is always called on the
+	 *        io_service.
+	 *        NOTE: both the socket and the file stream must outlive the
+	 *        operation, and no other send should be issued on this socket
+	 *        until the callback is called.
+	 */
+	void AsyncSendFile(
+		RBinaryIOSBase& file,
+		size_t offset,
+		size_t length,
+		AsyncSendFileCallback callback
+	)
+	{
+		length = ClampFileRange(file, offset, length);
+
+		std::shared_ptr<AsyncSendFileHandler> handler =
+			std::make_shared<AsyncSendFileHandler>(
+				*this,
+				file,
+				offset,
+				length,
+				std::move(callback)
+			);
+
+		boost::asio::post(
+			m_socket.get_executor(),
+			[handler]()
+			{
+				handler->Continue();
+			}
+		);
+	}
+
+
 protected:
 
 
 	TCPSocket(std::shared_ptr<boost::asio::io_service> ioService) :
 		StreamSocketBase(),
 		m_ioService(std::move(ioService)),
-		m_socket(*m_ioService)
+		m_socket(*m_ioService),
+		m_recvPool(),
+		m_sendMutex(),
+		m_sendQueue(),
+		m_isSending(false),
+		m_sendBatch()
 	{}
 
 
@@ -206,6 +823,32 @@ protected:
 	}
 
 
+	virtual void SendRawV(
+		const ConstBytesView* segments,
+		size_t segCount
+	) override
+	{
+		// a fixed number of segments per call, so no allocation is needed;
+		// unused slots are left empty
+		std::array<boost::asio::const_buffer, sk_maxSendVSegments> buffers;
+		for (size_t i = 0; i < segCount; i += buffers.size())
+		{
+			size_t count = (segCount - i) < buffers.size() ?
+				(segCount - i) : buffers.size();
+			for (size_t j = 0; j < buffers.size(); ++j)
+			{
+				buffers[j] = (j < count) ?
+					boost::asio::buffer(
+						segments[i + j].data(),
+						segments[i + j].size()
+					) :
+					boost::asio::const_buffer();
+			}
+			boost::asio::write(m_socket, buffers);
+		}
+	}
+
+
 	virtual size_t RecvRaw(void* data, size_t size) override
 	{
 		return m_socket.receive(boost::asio::buffer(data, size));
@@ -217,32 +860,480 @@ protected:
 		AsyncRecvCallback callback
 	) override
 	{
-		std::shared_ptr<AsyncRecvHandler> handler =
-			std::make_shared<AsyncRecvHandler>(
-				buffSize,
-				std::move(callback)
+		AsyncRecvHandler handler(buffSize, std::move(callback));
+		auto buffer = boost::asio::buffer(
+			handler.m_buffer.data(),
+			handler.m_buffer.size()
+		);
+
+		m_socket.async_receive(buffer, std::move(handler));
+	}
+
+
+	/**
+	 * @brief Receive exactly `expSize` bytes asynchronously.
+	 *        The destination is allocated once, with the full size, and
+	 *        asio fills it in place, however many segments the data arrives
+	 *        in; there is no intermediate buffer, copy, or per-segment
+	 *        allocation.
+	 */
+	virtual void AsyncRecvRawUntilComplete(
+		size_t expSize,
+		AsyncRecvCallback callback
+	) override
+	{
+		AsyncRecvUntilCompleteHandler handler(expSize, std::move(callback));
+		auto buffer = boost::asio::buffer(
+			handler.m_buffer.data(),
+			handler.m_buffer.size()
+		);
+
+		boost::asio::async_read(m_socket, buffer, std::move(handler));
+	}
+
+
+	/**
+	 * @brief Queue the data to be sent by the io_service of this socket;
+	 *        it can be called from any thread.
+	 *        Data queued while a write is in progress is sent by the next
+	 *        write, which gathers up to `sk_maxSendBatch` queued pieces, so
+	 *        many small sends cost one system call.
+	 *        NOTE: the socket must outlive the pending sends.
+	 */
+	virtual void AsyncSendRaw(
+		std::vector<uint8_t> data,
+		AsyncSendCallback callback
+	) override
+	{
+		bool toStart = false;
+		{
+			std::lock_guard<std::mutex> lock(m_sendMutex);
+			m_sendQueue.push_back(
+				PendingSend{ std::move(data), std::move(callback) }
+			);
+			if (!m_isSending)
+			{
+				m_isSending = true;
+				toStart = true;
+			}
+		}
+
+		if (toStart)
+		{
+			boost::asio::post(
+				m_socket.get_executor(),
+				[this]()
+				{
+					StartSendBatch();
+				}
 			);
+		}
+	}
+
+
+private:
 
-		m_socket.async_receive(
-			boost::asio::buffer(
-				handler->m_buffer.data(),
-				handler->m_buffer.size()
-			),
-			std::bind(
-				&AsyncRecvHandler::Handler,
-				handler,
-				std::placeholders::_1,
-				std::placeholders::_2
+
+	struct PendingSend
+	{
+		std::vector<uint8_t> m_data;
+		AsyncSendCallback m_callback;
+	}; // struct PendingSend
+
+
+	/**
+	 * @brief Move queued data into the batch, and write it; only called on
+	 *        the io_service, by one write at a time
+	 */
+	void StartSendBatch()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sendMutex);
+			while (
+				!m_sendQueue.empty() &&
+				(m_sendBatch.size() < sk_maxSendBatch)
 			)
+			{
+				m_sendBatch.push_back(std::move(m_sendQueue.front()));
+				m_sendQueue.pop_front();
+			}
+		}
+
+		std::vector<boost::asio::const_buffer> buffers;
+		buffers.reserve(m_sendBatch.size());
+		for (const PendingSend& pending : m_sendBatch)
+		{
+			buffers.push_back(
+				boost::asio::buffer(
+					pending.m_data.data(),
+					pending.m_data.size()
+				)
+			);
+		}
+
+		boost::asio::async_write(
+			m_socket,
+			buffers,
+			AsyncSendQueueHandler{ this }
 		);
 	}
 
 
-private:
+	void OnSendBatchDone(
+		const boost::system::error_code& error,
+		size_t bytesTransferred
+	)
+	{
+		// the state is brought up to date, and the next write is started,
+		// before any callback is called, so a callback that throws does not
+		// stall the queue
+		std::vector<PendingSend> batch;
+		batch.swap(m_sendBatch);
+
+		bool hasMore = false;
+		{
+			std::lock_guard<std::mutex> lock(m_sendMutex);
+			hasMore = !m_sendQueue.empty();
+			m_isSending = hasMore;
+		}
+		if (hasMore)
+		{
+			StartSendBatch();
+		}
+
+		// every callback of the batch is called, even if an earlier one
+		// throws; the first exception is then passed on to the io_service
+		std::exception_ptr firstException;
+		for (PendingSend& pending : batch)
+		{
+			size_t sent = (bytesTransferred < pending.m_data.size()) ?
+				bytesTransferred : pending.m_data.size();
+			bytesTransferred -= sent;
+
+			if (pending.m_callback)
+			{
+				try
+				{
+					pending.m_callback(
+						sent,
+						static_cast<bool>(error) ||
+							(sent < pending.m_data.size())
+					);
+				}
+				catch (...)
+				{
+					if (!firstException)
+					{
+						firstException = std::current_exception();
+					}
+				}
+			}
+		}
+		if (firstException)
+		{
+			std::rethrow_exception(firstException);
+		}
+	}
+
+
+	static size_t ClampFileRange(
+		RBinaryIOSBase& file,
+		size_t offset,
+		size_t length
+	)
+	{
+		size_t fileSize = file.GetFileSize();
+		if (offset >= fileSize)
+		{
+			return 0;
+		}
+		return (length < fileSize - offset) ? length : (fileSize - offset);
+	}
+
+
+	/**
+	 * @brief Get the file descriptor to be given to `sendfile`, or -1 if the
+	 *        data has to go through the user space
+	 */
+	int KernelSendFD(RBinaryIOSBase& file)
+	{
+#if defined(__linux__)
+		return file.GetNativeFD();
+#else
+		(void)file;
+		return -1;
+#endif // defined(__linux__)
+	}
+
+
+	/**
+	 * @brief Send some bytes of the file with one `sendfile` call
+	 *
+	 * @param isBlocked Set to true if the socket buffer is full
+	 * @return The number of bytes sent; 0 if the end of the file is
+	 *         reached, or if `sendfile` does not support the file
+	 */
+	size_t KernelSendSome(
+		int fileFD,
+		size_t offset,
+		size_t length,
+		bool& isBlocked
+	)
+	{
+		isBlocked = false;
+#if defined(__linux__)
+		off_t off = Internal::Obj::RealNumCast<off_t>(offset);
+		while (true)
+		{
+			ssize_t res = ::sendfile(
+				m_socket.native_handle(),
+				fileFD,
+				&off,
+				(length < sk_maxSendFileChunk ? length : sk_maxSendFileChunk)
+			);
+			if (res >= 0)
+			{
+				return static_cast<size_t>(res);
+			}
+
+			int err = errno;
+			if (err == EINTR)
+			{
+				continue;
+			}
+			if ((err == EAGAIN) || (err == EWOULDBLOCK))
+			{
+				isBlocked = true;
+				return 0;
+			}
+			if ((err == EINVAL) || (err == ENOSYS) || (err == EOPNOTSUPP))
+			{
+				return 0;
+			}
+			throw boost::system::system_error(
+				boost::system::error_code(
+					err,
+					boost::system::system_category()
+				),
+				"sendfile"
+			);
+		}
+#else
+		(void)fileFD;
+		(void)offset;
+		(void)length;
+		return 0;
+#endif // defined(__linux__)
+	}
+
+
+#if defined(__linux__)
+	/**
+	 * @brief A pipe used to splice data between two other descriptors
+	 */
+	struct SplicePipe
+	{
+		SplicePipe() :
+			m_readFD(-1),
+			m_writeFD(-1)
+		{
+			int fds[2];
+			if (::pipe2(fds, O_CLOEXEC) == 0)
+			{
+				m_readFD = fds[0];
+				m_writeFD = fds[1];
+				// best effort; a smaller pipe only means more calls
+				::fcntl(
+					m_writeFD,
+					F_SETPIPE_SZ,
+					static_cast<int>(sk_recvToFilePipeSize)
+				);
+			}
+		}
+
+		SplicePipe(const SplicePipe&) = delete;
+
+		~SplicePipe()
+		{
+			if (m_readFD >= 0)
+			{
+				::close(m_readFD);
+				::close(m_writeFD);
+			}
+		}
+
+		SplicePipe& operator=(const SplicePipe&) = delete;
+
+		int m_readFD;
+		int m_writeFD;
+	}; // struct SplicePipe
+#endif // defined(__linux__)
+
+
+	/**
+	 * @brief Get the file descriptor to be given to `splice`, or -1 if the
+	 *        data has to go through the user space
+	 */
+	int KernelRecvFD(WBinaryIOSBase& file)
+	{
+#if defined(__linux__)
+		return file.GetNativeFD();
+#else
+		(void)file;
+		return -1;
+#endif // defined(__linux__)
+	}
+
+
+	/**
+	 * @brief Splice up to `length` bytes from the socket into the file at
+	 *        `offset`
+	 *
+	 * @param leftover Receives the bytes already taken from the socket but
+	 *                 not written, if the file does not support `splice`
+	 * @return The number of bytes written to the file; the rest should be
+	 *         received in the user space, if it is less than `length`
+	 */
+	size_t KernelRecvToFile(
+		int fileFD,
+		size_t offset,
+		size_t length,
+		std::vector<uint8_t>& leftover
+	)
+	{
+#if defined(__linux__)
+		SplicePipe splicePipe;
+		if (splicePipe.m_readFD < 0)
+		{
+			return 0;
+		}
+
+		size_t written = 0;
+		while (written < length)
+		{
+			size_t chunkSize = length - written;
+			if (chunkSize > sk_recvToFilePipeSize)
+			{
+				chunkSize = sk_recvToFilePipeSize;
+			}
+
+			ssize_t inPipe = ::splice(
+				m_socket.native_handle(), nullptr,
+				splicePipe.m_writeFD, nullptr,
+				chunkSize,
+				SPLICE_F_MOVE
+			);
+			if (inPipe < 0)
+			{
+				int err = errno;
+				if (err == EINTR)
+				{
+					continue;
+				}
+				if ((err == EAGAIN) || (err == EWOULDBLOCK))
+				{
+					m_socket.wait(boost::asio::ip::tcp::socket::wait_read);
+					continue;
+				}
+				if ((err == EINVAL) || (err == ENOSYS))
+				{
+					// nothing is taken from the socket yet
+					return written;
+				}
+				throw boost::system::system_error(
+					boost::system::error_code(
+						err,
+						boost::system::system_category()
+					),
+					"splice"
+				);
+			}
+			if (inPipe == 0)
+			{
+				throw boost::system::system_error(boost::asio::error::eof);
+			}
+
+			size_t drained = 0;
+			while (drained < static_cast<size_t>(inPipe))
+			{
+				loff_t off = Internal::Obj::RealNumCast<loff_t>(
+					offset + written
+				);
+				ssize_t res = ::splice(
+					splicePipe.m_readFD, nullptr,
+					fileFD, &off,
+					static_cast<size_t>(inPipe) - drained,
+					SPLICE_F_MOVE
+				);
+				if (res > 0)
+				{
+					drained += static_cast<size_t>(res);
+					written += static_cast<size_t>(res);
+					continue;
+				}
+
+				int err = errno;
+				if ((res < 0) && (err == EINTR))
+				{
+					continue;
+				}
+				if ((res < 0) &&
+					(err != EINVAL) &&
+					(err != ENOSYS) &&
+					(err != EOPNOTSUPP))
+				{
+					throw boost::system::system_error(
+						boost::system::error_code(
+							err,
+							boost::system::system_category()
+						),
+						"splice"
+					);
+				}
+
+				// the file does not support `splice`; take the bytes back
+				leftover.resize(static_cast<size_t>(inPipe) - drained);
+				size_t readSize = 0;
+				while (readSize < leftover.size())
+				{
+					ssize_t readRes = ::read(
+						splicePipe.m_readFD,
+						leftover.data() + readSize,
+						leftover.size() - readSize
+					);
+					if ((readRes < 0) && (errno == EINTR))
+					{
+						continue;
+					}
+					if (readRes <= 0)
+					{
+						throw Exception("Failed to read from the pipe");
+					}
+					readSize += static_cast<size_t>(readRes);
+				}
+				return written;
+			}
+		}
+		return written;
+#else
+		(void)fileFD;
+		(void)offset;
+		(void)length;
+		(void)leftover;
+		return 0;
+#endif // defined(__linux__)
+	}
 
 
 	std::shared_ptr<boost::asio::io_service> m_ioService;
 	boost::asio::ip::tcp::socket m_socket;
+	std::shared_ptr<AlignedBufferPool> m_recvPool;
+
+	std::mutex m_sendMutex;
+	std::deque<PendingSend> m_sendQueue;
+	bool m_isSending;
+	// the data being written; only used on the io_service
+	std::vector<PendingSend> m_sendBatch;
 
 
 }; // class TCPSocket
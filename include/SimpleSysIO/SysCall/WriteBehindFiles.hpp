@@ -0,0 +1,89 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include "../Config.hpp"
+
+
+#ifdef SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
+
+
+#include <memory>
+#include <string>
+
+#include "../Internal/SimpleObjects.hpp"
+#include "../WriteBehindBinaryIOS.hpp"
+#include "Files.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace SysCall
+{
+
+/**
+ * @brief Open files for writing with write-behind: writes return once the
+ *        data is copied into a buffer, and a background thread writes the
+ *        buffers to the file; `Flush()` waits for them.
+ *        The file is written through its descriptor where available, since
+ *        the buffering is done here already.
+ *
+ * @param bufferSize The size of each buffer
+ * @param numBuffers The number of buffers; at least 2
+ */
+struct WriteBehindWBinaryFile
+{
+	using WrapperType = WriteBehindWBinaryIOS;
+	using RetType = std::unique_ptr<WrapperType>;
+
+	static RetType Create(
+		const std::string& path,
+		size_t bufferSize = WrapperType::sk_defBufferSize,
+		size_t numBuffers = WrapperType::sk_defNumBuffers
+	)
+	{
+#if !defined(_WIN32)
+		auto inner = WBinaryFile::CreateFD(path);
+#else
+		auto inner = WBinaryFile::Create(path);
+#endif // !defined(_WIN32)
+		return Internal::Obj::Internal::make_unique<WrapperType>(
+			std::move(inner),
+			bufferSize,
+			numBuffers
+		);
+	}
+
+	static RetType Append(
+		const std::string& path,
+		size_t bufferSize = WrapperType::sk_defBufferSize,
+		size_t numBuffers = WrapperType::sk_defNumBuffers
+	)
+	{
+#if !defined(_WIN32)
+		auto inner = WBinaryFile::AppendFD(path);
+#else
+		auto inner = WBinaryFile::Append(path);
+#endif // !defined(_WIN32)
+		return Internal::Obj::Internal::make_unique<WrapperType>(
+			std::move(inner),
+			bufferSize,
+			numBuffers
+		);
+	}
+}; // struct WriteBehindWBinaryFile
+
+
+} // namespace SysCall
+} // namespace SimpleSysIO
+
+#endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
@@ -0,0 +1,454 @@
+// Copyright (c) 2022 Haofan Zheng
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file or at
+// https://opensource.org/licenses/MIT.
+
+#pragma once
+
+
+#include <cstring>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "BinaryIOStreamBase.hpp"
+#include "DefaultInitAllocator.hpp"
+#include "Exceptions.hpp"
+#include "Internal/SimpleObjects.hpp"
+
+
+#ifndef SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+namespace SimpleSysIO
+#else
+namespace SIMPLESYSIO_CUSTOMIZED_NAMESPACE
+#endif
+{
+
+namespace Internal
+{
+
+/**
+ * @brief Write-behind on top of any write-only binary stream.
+ *        Writes are copied into one of a fixed set of buffers and return
+ *        right away; a background thread writes full buffers to the
+ *        underlying stream, in order, while the caller fills the next one.
+ *        The caller only waits when all buffers are waiting to be written.
+ */
+class WriteBehindWImpl
+{
+public: // static members:
+
+	static constexpr size_t sk_defBufferSize = 1024 * 1024;
+	static constexpr size_t sk_defNumBuffers = 4;
+
+public:
+
+	WriteBehindWImpl(
+		std::unique_ptr<WBinaryIOSBase> inner,
+		size_t bufferSize,
+		size_t numBuffers
+	) :
+		m_inner(std::move(inner)),
+		m_bufferSize(bufferSize),
+		m_current(),
+		m_pos(0),
+		m_mutex(),
+		m_cond(),
+		m_free(),
+		m_full(),
+		m_isWriting(false),
+		m_isStopping(false),
+		m_error(),
+		m_writer()
+	{
+		if (m_inner == nullptr)
+		{
+			throw Exception("The underlying stream is not given");
+		}
+		if (bufferSize == 0)
+		{
+			throw Exception("Invalid buffer size");
+		}
+		if (numBuffers < 2)
+		{
+			throw Exception("At least two buffers are needed");
+		}
+
+		m_current.reserve(m_bufferSize);
+		for (size_t i = 1; i < numBuffers; ++i)
+		{
+			m_free.emplace_back();
+			m_free.back().reserve(m_bufferSize);
+		}
+		m_pos = m_inner->Tell();
+
+		m_writer = std::thread(&WriteBehindWImpl::WriterMain, this);
+	}
+
+
+	~WriteBehindWImpl()
+	{
+		try
+		{
+			SubmitCurrent();
+			WaitForWriter();
+		}
+		catch (...)
+		{}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isStopping = true;
+		}
+		m_cond.notify_all();
+		m_writer.join();
+	}
+
+
+	void Seek(
+		std::ptrdiff_t offset,
+		SeekWhence whence = SeekWhence::Begin
+	)
+	{
+		Drain();
+		m_inner->Seek(offset, whence);
+		m_pos = m_inner->Tell();
+	}
+
+
+	size_t Tell() const
+	{
+		return m_pos;
+	}
+
+
+	/**
+	 * @brief Wait for all pending data to be written, and then flush the
+	 *        underlying stream
+	 *
+	 * @exception Exception (or the exception thrown by the underlying
+	 *            stream) if a background write has failed
+	 */
+	void Flush()
+	{
+		Drain();
+		m_inner->Flush();
+		// re-sync with the underlying stream, since it may be in the
+		// append mode
+		m_pos = m_inner->Tell();
+	}
+
+
+	void WriteBytesRaw(const void* buffer, size_t size)
+	{
+		const uint8_t* src = static_cast<const uint8_t*>(buffer);
+		while (size > 0)
+		{
+			if (m_current.size() == m_bufferSize)
+			{
+				SubmitCurrent();
+			}
+
+			size_t chunkSize = m_bufferSize - m_current.size();
+			chunkSize = (size < chunkSize) ? size : chunkSize;
+
+			size_t used = m_current.size();
+			m_current.resize(used + chunkSize);
+			std::memcpy(m_current.data() + used, src, chunkSize);
+
+			src += chunkSize;
+			size -= chunkSize;
+			m_pos += chunkSize;
+		}
+	}
+
+
+	void WriteAtRaw(size_t offset, const void* buffer, size_t size)
+	{
+		// pending data must land first, in case the ranges overlap
+		Drain();
+		Internal::BinaryIOSRaw::WriteAt(*m_inner, offset, buffer, size);
+	}
+
+
+	void WriteBytesVRaw(const ConstBytesView* segments, size_t segCount)
+	{
+		for (size_t i = 0; i < segCount; ++i)
+		{
+			WriteBytesRaw(segments[i].data(), segments[i].size());
+		}
+	}
+
+
+	void WriteAtVRaw(
+		size_t offset,
+		const ConstBytesView* segments,
+		size_t segCount
+	)
+	{
+		Drain();
+		Internal::BinaryIOSRaw::WriteAtV(*m_inner, offset, segments, segCount);
+	}
+
+
+	FileStat GetStat()
+	{
+		Drain();
+		return m_inner->GetStat();
+	}
+
+
+	int GetNativeFD() const
+	{
+		// pending data is not visible through the descriptor
+		return -1;
+	}
+
+
+	size_t GetBufferSize() const
+	{
+		return m_bufferSize;
+	}
+
+
+	/**
+	 * @brief Get the number of buffers waiting to be written, or being
+	 *        written, by the background thread
+	 */
+	size_t GetNumPending() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_full.size() + (m_isWriting ? 1 : 0);
+	}
+
+
+private:
+
+	using BufferType = UninitBytesVector;
+
+
+	/**
+	 * @brief Hand the current buffer to the background thread, and take a
+	 *        free one, waiting for it if there is none
+	 */
+	void SubmitCurrent()
+	{
+		if (m_current.empty())
+		{
+			ThrowIfFailed();
+			return;
+		}
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		ThrowIfFailedLocked();
+
+		m_full.emplace_back(std::move(m_current));
+		m_cond.notify_all();
+
+		m_cond.wait(
+			lock,
+			[this]()
+			{
+				return !m_free.empty() || (m_error != nullptr);
+			}
+		);
+		if (m_free.empty())
+		{
+			// the background thread stopped writing after an error
+			m_current = BufferType();
+			m_current.reserve(m_bufferSize);
+			ThrowIfFailedLocked();
+		}
+		m_current = std::move(m_free.front());
+		m_free.pop_front();
+	}
+
+
+	/**
+	 * @brief Write everything pending, and wait for it to complete, so the
+	 *        underlying stream can be used on this thread
+	 */
+	void Drain()
+	{
+		SubmitCurrent();
+		WaitForWriter();
+		ThrowIfFailed();
+	}
+
+
+	void WaitForWriter()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(
+			lock,
+			[this]()
+			{
+				return (m_full.empty() && !m_isWriting) ||
+					(m_error != nullptr);
+			}
+		);
+	}
+
+
+	void ThrowIfFailed() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ThrowIfFailedLocked();
+	}
+
+
+	void ThrowIfFailedLocked() const
+	{
+		if (m_error != nullptr)
+		{
+			std::rethrow_exception(m_error);
+		}
+	}
+
+
+	void WriterMain()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_cond.wait(
+				lock,
+				[this]()
+				{
+					return m_isStopping ||
+						(!m_full.empty() && (m_error == nullptr));
+				}
+			);
+			if (m_full.empty() || (m_error != nullptr))
+			{
+				// stopping; all data has been written, or cannot be
+				return;
+			}
+
+			BufferType buffer = std::move(m_full.front());
+			m_full.pop_front();
+			m_isWriting = true;
+
+			lock.unlock();
+			std::exception_ptr error;
+			try
+			{
+				Internal::BinaryIOSRaw::Write(
+					*m_inner,
+					buffer.data(),
+					buffer.size()
+				);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+			buffer.clear();
+			lock.lock();
+
+			m_isWriting = false;
+			if (error != nullptr)
+			{
+				// data after a failed write must not be written
+				m_error = error;
+				m_full.clear();
+			}
+			m_free.emplace_back(std::move(buffer));
+			m_cond.notify_all();
+		}
+	}
+
+
+	std::unique_ptr<WBinaryIOSBase> m_inner;
+	size_t m_bufferSize;
+	// the buffer being filled; only used by the caller's thread
+	BufferType m_current;
+	// the logical position, including pending data
+	size_t m_pos;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::deque<BufferType> m_free;
+	std::deque<BufferType> m_full;
+	bool m_isWriting;
+	bool m_isStopping;
+	std::exception_ptr m_error;
+
+	std::thread m_writer;
+
+}; // class WriteBehindWImpl
+
+} // namespace Internal
+
+
+/**
+ * @brief A decorator making writes to any write-only binary stream
+ *        asynchronous: `WriteBytes` copies the data into a buffer and
+ *        returns, and a background thread writes full buffers to the
+ *        underlying stream.
+ *        `Flush()` is the synchronization point: it waits for all pending
+ *        data to be written, and reports any error that has occurred in the
+ *        background. `Seek`, positional writes and `GetStat` wait as well.
+ *        NOTE: after a background write fails, all following calls throw,
+ *        and the pending data is dropped.
+ *        NOTE: the underlying stream must not be used directly while it is
+ *        wrapped.
+ */
+class WriteBehindWBinaryIOS :
+	public WBinaryIOSWrapper<Internal::WriteBehindWImpl>
+{
+public: // static members:
+
+	using ImplType = Internal::WriteBehindWImpl;
+	using Base = WBinaryIOSWrapper<ImplType>;
+
+	static constexpr size_t sk_defBufferSize = ImplType::sk_defBufferSize;
+	static constexpr size_t sk_defNumBuffers = ImplType::sk_defNumBuffers;
+
+public:
+
+	/**
+	 * @param bufferSize The size of each buffer
+	 * @param numBuffers The number of buffers, including the one being
+	 *                   filled; at least 2
+	 */
+	WriteBehindWBinaryIOS(
+		std::unique_ptr<WBinaryIOSBase> inner,
+		size_t bufferSize = sk_defBufferSize,
+		size_t numBuffers = sk_defNumBuffers
+	) :
+		Base(
+			Internal::Obj::Internal::make_unique<ImplType>(
+				std::move(inner),
+				bufferSize,
+				numBuffers
+			)
+		)
+	{}
+
+
+	// LCOV_EXCL_START
+	virtual ~WriteBehindWBinaryIOS() = default;
+	// LCOV_EXCL_STOP
+
+
+	size_t GetBufferSize() const
+	{
+		return GetImpl().GetBufferSize();
+	}
+
+
+	size_t GetNumPending() const
+	{
+		return GetImpl().GetNumPending();
+	}
+
+}; // class WriteBehindWBinaryIOS
+
+
+} // namespace SimpleSysIO
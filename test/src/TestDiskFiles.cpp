@@ -5,9 +5,31 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <random>
-
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <SimpleSysIO/BufferedBinaryIOS.hpp>
+#include <SimpleSysIO/ChecksumBinaryIOS.hpp>
+#include <SimpleSysIO/CRC32C.hpp>
+#include <SimpleSysIO/ParallelChunkReader.hpp>
+#include <SimpleSysIO/SysCall/AsyncFiles.hpp>
+#include <SimpleSysIO/SysCall/DirectFiles.hpp>
+#include <SimpleSysIO/SysCall/FileCopy.hpp>
 #include <SimpleSysIO/SysCall/Files.hpp>
+#include <SimpleSysIO/SysCall/RecordFiles.hpp>
+#include <SimpleSysIO/SysCall/WriteBehindFiles.hpp>
+#include <SimpleSysIO/SysCall/GroupCommitLog.hpp>
+#include <SimpleSysIO/SysCall/MMapFiles.hpp>
+
+#if !defined(_WIN32)
+#	include <sys/stat.h>
+#endif // !defined(_WIN32)
 
 
 #ifdef SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
@@ -289,4 +311,2291 @@ GTEST_TEST(TestDiskFiles, BinaryReadWriteAppend)
 	remove(fileName.c_str());
 }
 
+
+using RFileOpener =
+	std::unique_ptr<RBinaryIOSBase>(*)(const std::string&);
+using WFileOpener =
+	std::unique_ptr<WBinaryIOSBase>(*)(const std::string&);
+using RWFileOpener =
+	std::unique_ptr<RWBinaryIOSBase>(*)(const std::string&);
+using WPreallocFileOpener =
+	std::unique_ptr<WBinaryIOSBase>(*)(const std::string&, size_t);
+using RWPreallocFileOpener =
+	std::unique_ptr<RWBinaryIOSBase>(*)(const std::string&, size_t);
+using RHintFileOpener =
+	std::unique_ptr<RBinaryIOSBase>(*)(
+		const std::string&,
+		SysCall::AccessHint,
+		size_t
+	);
+
+
+/**
+ * @brief The openers of each implementation of binary files, so the same
+ *        tests can be run against all of them
+ */
+struct CBinaryFiles
+{
+	static const char* GetName()
+	{
+		return "C";
+	}
+
+	static std::unique_ptr<RBinaryIOSBase> OpenR(const std::string& path)
+	{
+		return SysCall::RBinaryFile::Open(path);
+	}
+
+	static std::unique_ptr<RBinaryIOSBase> OpenR(
+		const std::string& path,
+		SysCall::AccessHint hint,
+		size_t readaheadSize
+	)
+	{
+		return SysCall::RBinaryFile::Open(path, hint, readaheadSize);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> CreateW(const std::string& path)
+	{
+		return SysCall::WBinaryFile::Create(path);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> CreateW(
+		const std::string& path,
+		size_t expectedSize
+	)
+	{
+		return SysCall::WBinaryFile::Create(path, expectedSize);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> AppendW(const std::string& path)
+	{
+		return SysCall::WBinaryFile::Append(path);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> CreateRW(const std::string& path)
+	{
+		return SysCall::RWBinaryFile::Create(path);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> CreateRW(
+		const std::string& path,
+		size_t expectedSize
+	)
+	{
+		return SysCall::RWBinaryFile::Create(path, expectedSize);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> AppendRW(const std::string& path)
+	{
+		return SysCall::RWBinaryFile::Append(path);
+	}
+}; // struct CBinaryFiles
+
+
+#if !defined(_WIN32)
+
+struct FDBinaryFiles
+{
+	static const char* GetName()
+	{
+		return "FD";
+	}
+
+	static std::unique_ptr<RBinaryIOSBase> OpenR(const std::string& path)
+	{
+		return SysCall::RBinaryFile::OpenFD(path);
+	}
+
+	static std::unique_ptr<RBinaryIOSBase> OpenR(
+		const std::string& path,
+		SysCall::AccessHint hint,
+		size_t readaheadSize
+	)
+	{
+		return SysCall::RBinaryFile::OpenFD(path, hint, readaheadSize);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> CreateW(const std::string& path)
+	{
+		return SysCall::WBinaryFile::CreateFD(path);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> CreateW(
+		const std::string& path,
+		size_t expectedSize
+	)
+	{
+		return SysCall::WBinaryFile::CreateFD(path, expectedSize);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> AppendW(const std::string& path)
+	{
+		return SysCall::WBinaryFile::AppendFD(path);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> CreateRW(const std::string& path)
+	{
+		return SysCall::RWBinaryFile::CreateFD(path);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> CreateRW(
+		const std::string& path,
+		size_t expectedSize
+	)
+	{
+		return SysCall::RWBinaryFile::CreateFD(path, expectedSize);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> AppendRW(const std::string& path)
+	{
+		return SysCall::RWBinaryFile::AppendFD(path);
+	}
+}; // struct FDBinaryFiles
+
+
+/**
+ * @brief Only the read-write openers are memory-mapped; the files are
+ *        checked with the other implementations
+ */
+struct MMapBinaryFiles
+{
+	static const char* GetName()
+	{
+		return "MMap";
+	}
+
+	static std::unique_ptr<RBinaryIOSBase> OpenR(const std::string& path)
+	{
+		return SysCall::RBinaryFile::Open(path);
+	}
+
+	static std::unique_ptr<WBinaryIOSBase> CreateW(const std::string& path)
+	{
+		return SysCall::WBinaryFile::Create(path);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> CreateRW(const std::string& path)
+	{
+		// one page per step, so the file grows many times
+		return SysCall::MMapRWBinaryFile::Create(path, 1);
+	}
+
+	static std::unique_ptr<RWBinaryIOSBase> AppendRW(const std::string& path)
+	{
+		return SysCall::MMapRWBinaryFile::Append(path, 1);
+	}
+}; // struct MMapBinaryFiles
+
+#endif // !defined(_WIN32)
+
+
+/**
+ * @brief Names each instance of the typed tests after the implementation
+ */
+struct BinaryFilesName
+{
+	template<typename _Files>
+	static std::string GetName(int)
+	{
+		return _Files::GetName();
+	}
+}; // struct BinaryFilesName
+
+
+#if !defined(_WIN32)
+using AllBinaryFiles = ::testing::Types<CBinaryFiles, FDBinaryFiles>;
+using AllRWBinaryFiles =
+	::testing::Types<CBinaryFiles, FDBinaryFiles, MMapBinaryFiles>;
+#else
+using AllBinaryFiles = ::testing::Types<CBinaryFiles>;
+using AllRWBinaryFiles = ::testing::Types<CBinaryFiles>;
+#endif // !defined(_WIN32)
+
+
+// tests of the features shared by all implementations
+template<typename _Files>
+class TestBinaryFiles : public ::testing::Test
+{}; // class TestBinaryFiles
+
+TYPED_TEST_SUITE(TestBinaryFiles, AllBinaryFiles, BinaryFilesName);
+
+
+// tests that only need read-write files
+template<typename _Files>
+class TestRWBinaryFiles : public ::testing::Test
+{}; // class TestRWBinaryFiles
+
+TYPED_TEST_SUITE(TestRWBinaryFiles, AllRWBinaryFiles, BinaryFilesName);
+
+
+static void TestBinaryCreateWriteThenRead(
+	WFileOpener createW,
+	RFileOpener openR
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	{
+		// Open
+		auto file = createW(fileName);
+
+		// Write testing string
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		auto fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size());
+
+		// seek to current position
+		file->Seek(0, SeekWhence::Current);
+
+		// Write again
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 2);
+	}
+
+	{
+		// Open
+		auto file = openR(fileName);
+
+		std::string content;
+
+		// Read all
+		content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString + testingString);
+
+		// Check file size
+		auto fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 2);
+
+		// seek to begin
+		file->Seek(-1 * (testingString.size() * 2), SeekWhence::Current);
+
+		// Read partial
+		content = file->ReadBytes<std::string>(testingString.size());
+		ASSERT_EQ(content, testingString);
+
+		// Read till end but with larger count
+		content = file->ReadBytes<std::string>(testingString.size() * 2);
+		ASSERT_EQ(content, testingString);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, CreateWriteThenRead)
+{
+	TestBinaryCreateWriteThenRead(&TypeParam::CreateW, &TypeParam::OpenR);
+}
+
+
+static void TestBinaryAppendWriteThenRead(
+	WFileOpener createW,
+	WFileOpener appendW,
+	RFileOpener openR
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	// Write something to append on
+	{
+		auto file = createW(fileName);
+		file->WriteBytes(testingString);
+	}
+
+	// Append
+	{
+		auto file = appendW(fileName);
+
+		// Write testing string
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		auto fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 2);
+
+		// seek to current position
+		file->Seek(0, SeekWhence::Current);
+
+		// Write again
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 3);
+	}
+
+	// Read to compare
+	{
+		auto file = openR(fileName);
+
+		std::string content;
+
+		// Read all
+		content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString + testingString + testingString);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, AppendWriteThenRead)
+{
+	TestBinaryAppendWriteThenRead(
+		&TypeParam::CreateW,
+		&TypeParam::AppendW,
+		&TypeParam::OpenR
+	);
+}
+
+
+static void TestBinaryReadWriteCreate(RWFileOpener createRW)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	{
+		// Open
+		auto file = createRW(fileName);
+
+		// ===== Write =====
+
+		// Write testing string
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		auto fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size());
+
+		// seek to current position
+		file->Seek(0, SeekWhence::Current);
+
+		// Write again
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 2);
+
+		// ===== Read =====
+
+		// seek to begin
+		file->Seek(0);
+
+		std::string content;
+
+		// Read all
+		content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString + testingString);
+
+		// seek to begin
+		file->Seek(-1 * (testingString.size() * 2), SeekWhence::Current);
+
+		// Read partial
+		content = file->ReadBytes<std::string>(testingString.size());
+		ASSERT_EQ(content, testingString);
+
+		// Read till end but with larger count
+		content = file->ReadBytes<std::string>(testingString.size() * 2);
+		ASSERT_EQ(content, testingString);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestRWBinaryFiles, ReadWriteCreate)
+{
+	TestBinaryReadWriteCreate(&TypeParam::CreateRW);
+}
+
+
+static void TestBinaryReadWriteAppend(
+	WFileOpener createW,
+	RWFileOpener appendRW
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	// Write something to append on
+	{
+		auto file = createW(fileName);
+		file->WriteBytes(testingString);
+	}
+
+	{
+		// Open
+		auto file = appendRW(fileName);
+
+		// ===== Write =====
+
+		// Write testing string
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		auto fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 2);
+
+		// seek to current position
+		file->Seek(0, SeekWhence::Current);
+
+		// Write again
+		file->WriteBytes(testingString);
+		file->Flush();
+
+		// Check file size
+		fileSize = file->GetFileSize();
+		ASSERT_EQ(fileSize, testingString.size() * 3);
+
+		// ===== Read =====
+
+		std::string content;
+
+		// seek to begin
+		file->Seek(0);
+
+		// Read all
+		content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString + testingString + testingString);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestRWBinaryFiles, ReadWriteAppend)
+{
+	TestBinaryReadWriteAppend(&TypeParam::CreateW, &TypeParam::AppendRW);
+}
+
+
+static void TestBinaryPositionalReadWrite(
+	RWFileOpener createRW,
+	RFileOpener openR
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	{
+		auto file = createRW(fileName);
+
+		file->WriteBytes(testingString);
+		file->WriteBytes(testingString);
+
+		// positional write does not move the cursor
+		file->WriteAt(testingString.size(), std::string("HELLO"));
+		ASSERT_EQ(file->Tell(), testingString.size() * 2);
+
+		// positional read sees pending writes and does not move the cursor
+		file->Seek(1);
+		ASSERT_EQ(
+			file->ReadAt<std::string>(testingString.size(), 5),
+			"HELLO"
+		);
+		ASSERT_EQ(file->Tell(), 1);
+
+		// cursor based calls are not affected by the positional calls
+		ASSERT_EQ(
+			file->ReadBytes<std::string>(),
+			testingString.substr(1) + "HELLO" + testingString.substr(5)
+		);
+	}
+
+	{
+		auto file = openR(fileName);
+
+		// read beyond the end
+		ASSERT_EQ(
+			file->ReadAt<std::string>(testingString.size() * 2 - 1, 10),
+			"!"
+		);
+		ASSERT_EQ(
+			file->ReadAt<std::string>(testingString.size() * 2, 10),
+			std::string()
+		);
+
+		// concurrent reads on the same handle
+		std::vector<std::thread> threads;
+		std::vector<std::string> results(16);
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			threads.emplace_back([&file, &results, i]()
+				{
+					for (size_t j = 0; j < 100; ++j)
+					{
+						results[i] = file->ReadAt<std::string>(i % 6, 5);
+					}
+				}
+			);
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			ASSERT_EQ(results[i], testingString.substr(i % 6, 5));
+		}
+		ASSERT_EQ(file->Tell(), 0);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestRWBinaryFiles, PositionalReadWrite)
+{
+	TestBinaryPositionalReadWrite(&TypeParam::CreateRW, &TypeParam::OpenR);
+}
+
+
+static void TestBinaryVectoredReadWrite(
+	RWFileOpener createRW,
+	RFileOpener openR
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	struct Header
+	{
+		uint32_t m_magic;
+		uint32_t m_size;
+	};
+
+	std::string payload = "Hello, world!";
+	Header header;
+	header.m_magic = 0x12345678U;
+	header.m_size = static_cast<uint32_t>(payload.size());
+	const uint8_t trailer = 0xFFU;
+
+	// many tiny segments, more than what can be passed to one call
+	std::vector<uint8_t> tinyData(3000);
+	for (size_t i = 0; i < tinyData.size(); ++i)
+	{
+		tinyData[i] = static_cast<uint8_t>(i);
+	}
+	std::vector<ConstBytesView> tinySegs;
+	for (size_t i = 0; i < tinyData.size(); ++i)
+	{
+		tinySegs.emplace_back(&tinyData[i], 1);
+		// empty segments are skipped
+		tinySegs.emplace_back();
+	}
+
+	const size_t recordSize = sizeof(Header) + payload.size() + 1;
+
+	{
+		auto file = createRW(fileName);
+
+		file->WriteBytesV({
+			ConstBytesView(&header, sizeof(header)),
+			ConstBytesView(payload.data(), payload.size()),
+			ConstBytesView(&trailer, sizeof(trailer)),
+		});
+		ASSERT_EQ(file->Tell(), recordSize);
+
+		file->WriteBytesV(tinySegs);
+		ASSERT_EQ(file->Tell(), recordSize + tinyData.size());
+
+		// positional gather write does not move the cursor
+		std::string hello = "HELLO";
+		file->WriteAtV(
+			sizeof(Header),
+			{
+				ConstBytesView(hello.data(), 2),
+				ConstBytesView(),
+				ConstBytesView(hello.data() + 2, 3),
+			}
+		);
+		ASSERT_EQ(file->Tell(), recordSize + tinyData.size());
+	}
+
+	payload.replace(0, 5, "HELLO");
+
+	{
+		auto file = openR(fileName);
+
+		Header readHeader;
+		std::string readPayload(payload.size(), '\0');
+		uint8_t readTrailer = 0;
+
+		size_t readSize = file->ReadBytesV({
+			MutableBytesView(&readHeader, sizeof(readHeader)),
+			MutableBytesView(&readPayload[0], readPayload.size()),
+			MutableBytesView(&readTrailer, sizeof(readTrailer)),
+		});
+		ASSERT_EQ(readSize, recordSize);
+		ASSERT_EQ(readHeader.m_magic, header.m_magic);
+		ASSERT_EQ(readHeader.m_size, header.m_size);
+		ASSERT_EQ(readPayload, payload);
+		ASSERT_EQ(readTrailer, trailer);
+		ASSERT_EQ(file->Tell(), recordSize);
+
+		std::vector<uint8_t> readTiny(tinyData.size());
+		std::vector<MutableBytesView> readSegs;
+		for (size_t i = 0; i < readTiny.size(); ++i)
+		{
+			readSegs.emplace_back(&readTiny[i], 1);
+		}
+		// one more segment beyond the end of the file
+		uint8_t extra = 0;
+		readSegs.emplace_back(&extra, 1);
+
+		readSize = file->ReadBytesV(readSegs);
+		ASSERT_EQ(readSize, tinyData.size());
+		ASSERT_EQ(readTiny, tinyData);
+
+		// positional scatter read does not move the cursor
+		file->Seek(0);
+		std::string part1(3, '\0');
+		std::string part2(2, '\0');
+		readSize = file->ReadAtV(
+			sizeof(Header),
+			{
+				MutableBytesView(&part1[0], part1.size()),
+				MutableBytesView(&part2[0], part2.size()),
+			}
+		);
+		ASSERT_EQ(readSize, 5);
+		ASSERT_EQ(part1 + part2, "HELLO");
+		ASSERT_EQ(file->Tell(), 0);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestRWBinaryFiles, VectoredReadWrite)
+{
+	TestBinaryVectoredReadWrite(&TypeParam::CreateRW, &TypeParam::OpenR);
+}
+
+
+static void TestBinaryReadWithAccessHints(RHintFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	// larger than the batch in which `DontNeed` releases consumed pages
+	std::vector<uint8_t> expected(3 * 1024 * 1024 + 123);
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		expected[i] = static_cast<uint8_t>((i * 31) ^ (i >> 12));
+	}
+
+	{
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		file->WriteBytes(expected);
+	}
+
+	const SysCall::AccessHint hints[] = {
+		SysCall::AccessHint::Normal,
+		SysCall::AccessHint::Sequential,
+		SysCall::AccessHint::Random,
+		SysCall::AccessHint::WillNeed,
+		SysCall::AccessHint::DontNeed,
+	};
+	const size_t readaheadSizes[] = { 0, 64 * 1024 };
+
+	for (auto hint : hints)
+	{
+		for (auto readaheadSize : readaheadSizes)
+		{
+			auto file = openR(fileName, hint, readaheadSize);
+
+			// sequential scan in chunks
+			std::vector<uint8_t> content;
+			std::vector<uint8_t> chunk;
+			do
+			{
+				chunk = file->ReadBytes<std::vector<uint8_t> >(10000);
+				content.insert(content.end(), chunk.begin(), chunk.end());
+			} while (chunk.size() > 0);
+			ASSERT_EQ(content, expected);
+
+			// seeking backward restarts the readahead window
+			file->Seek(100);
+			ASSERT_EQ(
+				file->ReadBytes<std::vector<uint8_t> >(10),
+				std::vector<uint8_t>(
+					expected.begin() + 100,
+					expected.begin() + 110
+				)
+			);
+			ASSERT_EQ(
+				file->ReadAt<std::vector<uint8_t> >(2000000, 10),
+				std::vector<uint8_t>(
+					expected.begin() + 2000000,
+					expected.begin() + 2000010
+				)
+			);
+		}
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, ReadWithAccessHints)
+{
+	TestBinaryReadWithAccessHints(&TypeParam::OpenR);
+}
+
+
+static void TestBinaryBufferedReadWrite(WFileOpener createW, RFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	// a tiny buffer, so the boundaries are crossed frequently
+	const size_t bufferSize = 16;
+
+	std::string expected;
+	{
+		BufferedWBinaryIOS file(createW(fileName), bufferSize);
+		ASSERT_EQ(file.GetBufferSize(), bufferSize);
+
+		// small fields are collected in the buffer
+		for (uint32_t i = 0; i < 100; ++i)
+		{
+			std::string field = "#" + std::to_string(i);
+			file.WriteBytes(field);
+			expected += field;
+			ASSERT_EQ(file.Tell(), expected.size());
+		}
+
+		// larger than the buffer; written through
+		std::string large(100, 'L');
+		file.WriteBytes(large);
+		expected += large;
+
+		std::string part1 = "gather";
+		std::string part2 = "-write";
+		file.WriteBytesV({
+			ConstBytesView(part1.data(), part1.size()),
+			ConstBytesView(part2.data(), part2.size()),
+		});
+		expected += part1 + part2;
+		ASSERT_EQ(file.Tell(), expected.size());
+
+		// positional writes see the data written before
+		file.WriteAt(0, std::string("$$"));
+		expected.replace(0, 2, "$$");
+		ASSERT_EQ(file.GetFileSize(), expected.size());
+
+		file.WriteBytes(std::string("tail"));
+		expected += "tail";
+		// the remaining data is flushed on destruction
+	}
+
+	{
+		BufferedRBinaryIOS file(openR(fileName), bufferSize);
+		ASSERT_EQ(file.GetFileSize(), expected.size());
+
+		// read small fields one at a time
+		std::string content;
+		std::string field;
+		do
+		{
+			field = file.ReadBytes<std::string>(3);
+			content += field;
+			ASSERT_EQ(file.Tell(), content.size());
+		} while (field.size() > 0);
+		ASSERT_EQ(content, expected);
+
+		// seeking inside and outside of the window
+		file.Seek(expected.size() - 5);
+		ASSERT_EQ(
+			file.ReadBytes<std::string>(2),
+			expected.substr(expected.size() - 5, 2)
+		);
+		file.Seek(-2, SeekWhence::Current);
+		ASSERT_EQ(
+			file.ReadBytes<std::string>(),
+			expected.substr(expected.size() - 5)
+		);
+		file.Seek(10);
+		ASSERT_EQ(file.ReadBytes<std::string>(40), expected.substr(10, 40));
+		file.Seek(-4, SeekWhence::End);
+		ASSERT_EQ(file.ReadBytes<std::string>(10), "tail");
+		ASSERT_THROW(file.Seek(-1, SeekWhence::Begin), Exception);
+
+		// positional and scatter reads
+		file.Seek(20);
+		ASSERT_EQ(file.ReadAt<std::string>(21, 3), expected.substr(21, 3));
+		ASSERT_EQ(file.ReadAt<std::string>(200, 30), expected.substr(200, 30));
+		std::string part1(5, '\0');
+		std::string part2(50, '\0');
+		size_t readSize = file.ReadBytesV({
+			MutableBytesView(&part1[0], part1.size()),
+			MutableBytesView(&part2[0], part2.size()),
+		});
+		ASSERT_EQ(readSize, part1.size() + part2.size());
+		ASSERT_EQ(part1 + part2, expected.substr(20, readSize));
+		ASSERT_EQ(file.Tell(), 20 + readSize);
+	}
+
+	ASSERT_THROW(BufferedRBinaryIOS(nullptr), Exception);
+	ASSERT_THROW(BufferedRBinaryIOS(openR(fileName), 0), Exception);
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, BufferedReadWrite)
+{
+	TestBinaryBufferedReadWrite(&TypeParam::CreateW, &TypeParam::OpenR);
+}
+
+
+static void TestBinaryFileStat(WFileOpener createW, RFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	const auto startTime =
+		std::chrono::system_clock::now() - std::chrono::hours(1);
+
+	{
+		auto file = createW(fileName);
+		file->WriteBytes(testingString);
+
+		// data that has not been flushed yet is included
+		FileStat stat = file->GetStat();
+		ASSERT_EQ(stat.m_size, testingString.size());
+		ASSERT_EQ(file->GetFileSize(), testingString.size());
+#if !defined(_WIN32)
+		ASSERT_GT(stat.m_blockSize, 0);
+#endif // !defined(_WIN32)
+		ASSERT_GT(stat.m_modifiedTime, startTime);
+
+		file->WriteBytes(testingString);
+		ASSERT_EQ(file->GetStat().m_size, testingString.size() * 2);
+	}
+
+	{
+		auto file = openR(fileName);
+		FileStat stat = file->GetStat();
+		ASSERT_EQ(stat.m_size, testingString.size() * 2);
+		ASSERT_GT(stat.m_modifiedTime, startTime);
+
+		file->Seek(testingString.size());
+		ASSERT_EQ(file->ReadBytes<std::string>(), testingString);
+		ASSERT_EQ(file->Tell(), testingString.size() * 2);
+		ASSERT_EQ(file->ReadBytes<std::string>(), std::string());
+
+		// the size of a growing file is up to date
+		{
+			auto appender = SysCall::WBinaryFile::Append(fileName);
+			appender->WriteBytes(testingString);
+		}
+		ASSERT_EQ(file->GetFileSize(), testingString.size() * 3);
+		ASSERT_EQ(file->ReadBytes<std::string>(), testingString);
+	}
+
+	{
+		// the metadata is only cached when asked for
+		auto file = SysCall::RBinaryFile::OpenStatCached(fileName);
+		ASSERT_EQ(file->GetFileSize(), testingString.size() * 3);
+#if !defined(_WIN32)
+		auto fdFile = SysCall::RBinaryFile::OpenStatCachedFD(fileName);
+		ASSERT_EQ(fdFile->GetFileSize(), testingString.size() * 3);
+#endif // !defined(_WIN32)
+		{
+			auto appender = SysCall::WBinaryFile::Append(fileName);
+			appender->WriteBytes(testingString);
+		}
+		ASSERT_EQ(file->GetFileSize(), testingString.size() * 3);
+#if !defined(_WIN32)
+		ASSERT_EQ(fdFile->GetFileSize(), testingString.size() * 3);
+#endif // !defined(_WIN32)
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, FileStat)
+{
+	TestBinaryFileStat(&TypeParam::CreateW, &TypeParam::OpenR);
+}
+
+
+static void TestBinaryReadInto(RFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	{
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		for (size_t i = 0; i < 10; ++i)
+		{
+			file->WriteBytes(testingString);
+		}
+	}
+
+	{
+		auto file = openR(fileName);
+
+		// caller-owned buffer
+		std::string buffer(5, '\0');
+		ASSERT_EQ(
+			file->ReadInto(MutableBytesView(&buffer[0], buffer.size())),
+			buffer.size()
+		);
+		ASSERT_EQ(buffer, testingString.substr(0, 5));
+
+		// append to a reused container
+		UninitBytesVector dest;
+		dest.reserve(testingString.size() * 2);
+		const uint8_t* destPtr = dest.data();
+		ASSERT_EQ(file->ReadInto(dest, testingString.size() - 5), 8);
+		ASSERT_EQ(file->ReadInto(dest, testingString.size()), 13);
+		ASSERT_EQ(file->ReadInto(dest, 0), 0);
+		ASSERT_EQ(
+			std::string(dest.begin(), dest.end()),
+			testingString.substr(5) + testingString
+		);
+		// no reallocation happened
+		ASSERT_EQ(dest.data(), destPtr);
+
+		// steady-state loop till the end
+		size_t numRecords = 2;
+		do
+		{
+			dest.clear();
+			file->ReadInto(dest, testingString.size());
+			if (dest.size() > 0)
+			{
+				ASSERT_EQ(
+					std::string(dest.begin(), dest.end()),
+					testingString
+				);
+				++numRecords;
+			}
+		} while (dest.size() > 0);
+		ASSERT_EQ(numRecords, 10);
+		ASSERT_EQ(dest.data(), destPtr);
+
+		// other containers work too
+		std::string strDest = "prefix";
+		file->Seek(0);
+		ASSERT_EQ(file->ReadInto(strDest, 5), 5);
+		ASSERT_EQ(strDest, "prefixHello");
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, ReadInto)
+{
+	TestBinaryReadInto(&TypeParam::OpenR);
+}
+
+
+static void TestBinaryPreallocatedCreate(
+	WPreallocFileOpener createW,
+	RWPreallocFileOpener createRW
+)
+{
+	std::string fileName = GenRandomFileName();
+
+	const size_t expectedSize = 4 * 1024 * 1024;
+	const std::vector<uint8_t> chunk(10000, 0x5A);
+
+	{
+		auto file = createW(fileName, expectedSize);
+
+		// the reserved space does not count towards the file size
+		ASSERT_EQ(file->GetFileSize(), 0);
+		file->WriteBytes(chunk);
+		ASSERT_EQ(file->GetFileSize(), chunk.size());
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), chunk);
+	}
+
+#if !defined(_WIN32)
+	{
+		// the space not written is released on close
+		struct stat fileStat;
+		ASSERT_EQ(stat(fileName.c_str(), &fileStat), 0);
+		ASSERT_LT(static_cast<size_t>(fileStat.st_blocks) * 512, expectedSize);
+	}
+#endif // !defined(_WIN32)
+
+	{
+		auto file = createRW(fileName, expectedSize);
+		ASSERT_EQ(file->GetFileSize(), 0);
+		file->WriteBytes(chunk);
+		file->Seek(0);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), chunk);
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->GetFileSize(), chunk.size());
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, PreallocatedCreate)
+{
+	TestBinaryPreallocatedCreate(&TypeParam::CreateW, &TypeParam::CreateRW);
+}
+
+
+static void TestBinaryCopyRange(
+	RFileOpener openR,
+	WFileOpener createW,
+	RWFileOpener createRW
+)
+{
+	std::string srcName = GenRandomFileName();
+	std::string dstName = GenRandomFileName();
+
+	// spans multiple copy buffers
+	std::vector<uint8_t> expected(
+		SysCall::FileCopy::sk_copyBufferSize * 2 + 12345
+	);
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		expected[i] = static_cast<uint8_t>((i * 13) ^ (i >> 10));
+	}
+	{
+		auto file = SysCall::WBinaryFile::Create(srcName);
+		file->WriteBytes(expected);
+	}
+
+	{
+		auto src = openR(srcName);
+		auto dst = createW(dstName);
+
+		// pending data in the destination is flushed first
+		dst->WriteBytes(std::string("header"));
+
+		ASSERT_EQ(SysCall::FileCopy::CopyAll(*src, *dst), expected.size());
+		ASSERT_EQ(dst->GetFileSize(), expected.size());
+
+		// the positions are not affected
+		ASSERT_EQ(src->Tell(), 0);
+		ASSERT_EQ(dst->Tell(), 6);
+	}
+	{
+		auto file = SysCall::RBinaryFile::Open(dstName);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), expected);
+	}
+
+	{
+		auto src = openR(srcName);
+		auto dst = createRW(dstName);
+
+		// partial ranges at unaligned offsets
+		ASSERT_EQ(
+			SysCall::FileCopy::CopyRange(*src, 100, *dst, 7, 5000),
+			5000
+		);
+		// the range is cut at the end of the source
+		ASSERT_EQ(
+			SysCall::FileCopy::CopyRange(
+				*src,
+				expected.size() - 10,
+				*dst,
+				5007,
+				100
+			),
+			10
+		);
+		ASSERT_EQ(
+			SysCall::FileCopy::CopyRange(*src, expected.size(), *dst, 0, 1),
+			0
+		);
+		// an empty range inside the source copies nothing
+		ASSERT_EQ(
+			SysCall::FileCopy::CopyRange(*src, 0, *dst, 0, 0),
+			0
+		);
+		ASSERT_EQ(dst->GetFileSize(), 5017);
+
+		std::vector<uint8_t> content =
+			dst->ReadAt<std::vector<uint8_t> >(0, 6000);
+		ASSERT_EQ(content.size(), 5017);
+		ASSERT_EQ(
+			std::vector<uint8_t>(content.begin(), content.begin() + 7),
+			std::vector<uint8_t>(7, 0)
+		);
+		ASSERT_EQ(
+			std::vector<uint8_t>(content.begin() + 7, content.begin() + 5007),
+			std::vector<uint8_t>(
+				expected.begin() + 100,
+				expected.begin() + 5100
+			)
+		);
+		ASSERT_EQ(
+			std::vector<uint8_t>(content.begin() + 5007, content.end()),
+			std::vector<uint8_t>(expected.end() - 10, expected.end())
+		);
+	}
+
+	{
+		// streams without a usable descriptor go through the buffer
+		BufferedRBinaryIOS src(openR(srcName));
+		BufferedWBinaryIOS dst(createW(dstName));
+		ASSERT_EQ(SysCall::FileCopy::CopyAll(src, dst), expected.size());
+	}
+	{
+		auto file = SysCall::RBinaryFile::Open(dstName);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), expected);
+	}
+
+	// Clean up the testing file
+	remove(srcName.c_str());
+	remove(dstName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, CopyRange)
+{
+	TestBinaryCopyRange(
+		&TypeParam::OpenR,
+		&TypeParam::CreateW,
+		&TypeParam::CreateRW
+	);
+}
+
+
+static void TestBinaryParallelRead(RFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::vector<uint8_t> expected(1000003);
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		expected[i] = static_cast<uint8_t>((i * 31) ^ (i >> 8));
+	}
+	{
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		file->WriteBytes(expected);
+	}
+
+	ParallelChunkReader reader(4, 6);
+	ASSERT_EQ(reader.GetNumThreads(), 4);
+
+	auto file = openR(fileName);
+
+	// in order; the last chunk is shorter
+	std::vector<uint8_t> content;
+	size_t nextOffset = 0;
+	reader.Read(
+		*file,
+		ChunkOrder::InOrder,
+		[&](size_t offset, ParallelChunkReader::ChunkType chunk)
+		{
+			ASSERT_EQ(offset, nextOffset);
+			nextOffset += chunk.size();
+			content.insert(content.end(), chunk.begin(), chunk.end());
+		},
+		10000
+	);
+	ASSERT_EQ(content, expected);
+	ASSERT_EQ(file->Tell(), 0);
+
+	// as completed, within a range cut at the end of the file
+	content.assign(expected.size(), 0);
+	size_t numChunks = 0;
+	reader.Read(
+		*file,
+		5,
+		expected.size(),
+		4096,
+		ChunkOrder::AsCompleted,
+		[&](size_t offset, ParallelChunkReader::ChunkType chunk)
+		{
+			++numChunks;
+			std::copy(chunk.begin(), chunk.end(), content.begin() + offset);
+		}
+	);
+	ASSERT_EQ(numChunks, (expected.size() - 5 + 4095) / 4096);
+	ASSERT_EQ(
+		std::vector<uint8_t>(content.begin() + 5, content.end()),
+		std::vector<uint8_t>(expected.begin() + 5, expected.end())
+	);
+
+	// exceptions thrown by the callback stop the read
+	size_t numCalls = 0;
+	ASSERT_THROW(
+		reader.Read(
+			*file,
+			ChunkOrder::InOrder,
+			[&](size_t, ParallelChunkReader::ChunkType)
+			{
+				if (++numCalls == 3)
+				{
+					throw std::runtime_error("stop");
+				}
+			},
+			1000
+		),
+		std::runtime_error
+	);
+	ASSERT_EQ(numCalls, 3);
+
+	file.reset();
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, ParallelRead)
+{
+	TestBinaryParallelRead(&TypeParam::OpenR);
+}
+
+
+static void TestBinaryChecksum(WFileOpener createW, RFileOpener openR)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::vector<uint8_t> data(100000);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<uint8_t>((i * 17) ^ (i >> 7));
+	}
+	const uint32_t dataCrc = CRC32C::Compute(data.data(), data.size());
+
+	{
+		ChecksumWBinaryIOS file(createW(fileName));
+		file.WriteBytes(std::vector<uint8_t>(data.begin(), data.begin() + 10));
+		file.WriteBytesV({
+			ConstBytesView(data.data() + 10, 90),
+			ConstBytesView(data.data() + 100, data.size() - 100),
+		});
+		ASSERT_EQ(file.GetChecksum(), dataCrc);
+
+		// positional writes are not covered
+		file.WriteAt(0, std::string("x"));
+		ASSERT_EQ(file.GetChecksum(), dataCrc);
+		data[0] = 'x';
+		file.ResetChecksum();
+		ASSERT_EQ(file.GetChecksum(), 0);
+	}
+
+	{
+		ChecksumRBinaryIOS file(openR(fileName));
+		ASSERT_EQ(file.ReadBytes<std::vector<uint8_t> >(3).size(), 3);
+		UninitBytesVector dest;
+		file.ReadInto(dest, 5000);
+		std::vector<uint8_t> seg(1000);
+		ASSERT_EQ(
+			file.ReadBytesV({ MutableBytesView(seg.data(), seg.size()) }),
+			seg.size()
+		);
+		file.ReadBytes<std::vector<uint8_t> >();
+		ASSERT_EQ(
+			file.GetChecksum(),
+			CRC32C::Compute(data.data(), data.size())
+		);
+	}
+
+	// checksummed frames
+	std::vector<std::string> payloads = {
+		"Hello, world!", std::string(), std::string(70000, 'f'),
+	};
+	{
+		auto file = createW(fileName);
+		for (const auto& payload : payloads)
+		{
+			ChecksumFrame::Write(*file, payload);
+		}
+	}
+	{
+		auto file = openR(fileName);
+		std::string payload;
+		for (const auto& expPayload : payloads)
+		{
+			ASSERT_TRUE(ChecksumFrame::Read(*file, payload));
+			ASSERT_EQ(payload, expPayload);
+		}
+		ASSERT_FALSE(ChecksumFrame::Read(*file, payload));
+	}
+	{
+		// corrupt the payload of the first frame
+		auto file = SysCall::RWBinaryFile::Create(fileName);
+		ChecksumFrame::Write(*file, payloads[0]);
+		file->WriteAt(ChecksumFrame::sk_headerSize + 1, std::string("E"));
+		ChecksumFrame::Write(*file, payloads[0]);
+		file->WriteAt(file->Tell() - 1, std::string("?"));
+	}
+	{
+		auto file = openR(fileName);
+		std::string payload;
+		ASSERT_THROW(ChecksumFrame::Read(*file, payload), Exception);
+		// truncated frame
+		file->Seek(-1, SeekWhence::End);
+		ASSERT_THROW(ChecksumFrame::Read(*file, payload), Exception);
+	}
+	{
+		// a corrupted size field
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		uint8_t header[ChecksumFrame::sk_headerSize];
+		ChecksumFrame::MakeHeader(
+			header, payloads[0].data(), payloads[0].size()
+		);
+		// the size is little-endian
+		header[0] = 0xF0U;
+		header[1] = 0xFFU;
+		header[2] = 0xFFU;
+		header[3] = 0xFFU;
+		file->WriteBytes(ConstBytesView(header, sizeof(header)));
+		file->WriteBytes(payloads[0]);
+	}
+	{
+		auto file = openR(fileName);
+		std::string payload;
+		ASSERT_THROW(ChecksumFrame::Read(*file, payload), Exception);
+		// it's reported before the payload is allocated
+		ASSERT_LT(payload.capacity(), 1024 * 1024);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+TYPED_TEST(TestBinaryFiles, Checksum)
+{
+	TestBinaryChecksum(&TypeParam::CreateW, &TypeParam::OpenR);
+}
+
+
+GTEST_TEST(TestDiskFiles, CRC32C)
+{
+	// known values
+	const std::string check = "123456789";
+	ASSERT_EQ(CRC32C::Compute(check.data(), check.size()), 0xE3069283U);
+	std::vector<uint8_t> zeros(32, 0);
+	ASSERT_EQ(CRC32C::Compute(zeros.data(), zeros.size()), 0x8A9136AAU);
+	ASSERT_EQ(CRC32C::Compute(nullptr, 0), 0U);
+
+	// the hardware and portable implementations agree, at any alignment
+	// and length, and the checksum can be computed incrementally
+	std::vector<uint8_t> data(4096 + 16);
+	std::mt19937 gen(42);
+	for (auto& b : data)
+	{
+		b = static_cast<uint8_t>(gen());
+	}
+	for (size_t offset = 0; offset < 9; ++offset)
+	{
+		for (size_t len : { 0, 1, 7, 8, 9, 63, 1000, 4096 })
+		{
+			uint32_t crc = CRC32C::Compute(data.data() + offset, len);
+			uint32_t portable = ~Internal::CRC32CPortable::Update(
+				~0U, data.data() + offset, len
+			);
+			ASSERT_EQ(crc, portable);
+
+			size_t half = len / 2;
+			uint32_t incremental = CRC32C::Update(
+				CRC32C::Compute(data.data() + offset, half),
+				data.data() + offset + half,
+				len - half
+			);
+			ASSERT_EQ(crc, incremental);
+		}
+	}
+}
+
+
+#if !defined(_WIN32)
+
+GTEST_TEST(TestDiskFiles, FDBinaryReadNonExistFile)
+{
+	const auto fileName = GenRandomFileName();
+	ASSERT_THROW(
+		SysCall::RBinaryFile::OpenFD(fileName);,
+		Exception
+	);
+}
+
+
+GTEST_TEST(TestDiskFiles, FDBinaryLargeOffset)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	// an offset that does not fit in a 32-bit signed integer
+	const size_t largeOffset = (static_cast<size_t>(1) << 32) + 1;
+
+	{
+		// sparse file; no actual disk space is used for the hole
+		auto file = SysCall::RWBinaryFile::CreateFD(fileName);
+
+		file->Seek(largeOffset);
+		ASSERT_EQ(file->Tell(), largeOffset);
+
+		file->WriteBytes(testingString);
+		ASSERT_EQ(file->GetFileSize(), largeOffset + testingString.size());
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+
+		file->Seek(largeOffset);
+		ASSERT_EQ(file->Tell(), largeOffset);
+
+		std::string content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, MMapBinaryReadNonExistFile)
+{
+	const auto fileName = GenRandomFileName();
+	ASSERT_THROW(
+		SysCall::MMapRBinaryFile::Open(fileName);,
+		Exception
+	);
+}
+
+
+GTEST_TEST(TestDiskFiles, MMapBinaryRead)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::string testingString = "Hello, world!";
+
+	{
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		file->WriteBytes(testingString);
+		file->WriteBytes(testingString);
+	}
+
+	{
+		auto file = SysCall::MMapRBinaryFile::Open(fileName);
+
+		ASSERT_EQ(file->GetFileSize(), testingString.size() * 2);
+		ASSERT_EQ(file->GetStat().m_size, testingString.size() * 2);
+
+		// Read all through the base interface
+		std::string content = file->ReadBytes<std::string>();
+		ASSERT_EQ(content, testingString + testingString);
+		ASSERT_EQ(file->ReadBytes<std::string>(1), std::string());
+
+		// seek to begin
+		file->Seek(-1 * (testingString.size() * 2), SeekWhence::Current);
+
+		// Read partial through view
+		ConstBytesView view = file->ReadView(testingString.size());
+		ASSERT_EQ(view.Copy<std::string>(), testingString);
+		ASSERT_EQ(file->Tell(), testingString.size());
+
+		// Read till end but with larger count
+		view = file->ReadView(testingString.size() * 2);
+		ASSERT_EQ(view.Copy<std::string>(), testingString);
+		ASSERT_TRUE(file->ReadView().empty());
+
+		// positional views do not move the cursor
+		file->Seek(1);
+		view = file->GetView(testingString.size(), 5);
+		ASSERT_EQ(view.Copy<std::string>(), "Hello");
+		ASSERT_EQ(file->Tell(), 1);
+		ASSERT_EQ(file->GetView().size(), testingString.size() * 2);
+		ASSERT_TRUE(file->GetView(testingString.size() * 2, 1).empty());
+
+		// positional reads
+		ASSERT_EQ(
+			file->ReadAt<std::string>(testingString.size(), 5),
+			"Hello"
+		);
+		ASSERT_EQ(file->ReadAt<std::string>(testingString.size() * 2, 5), "");
+		ASSERT_EQ(file->Tell(), 1);
+
+		// scatter reads
+		std::string part1(5, '\0');
+		std::string part2(20, '\0');
+		size_t readSize = file->ReadBytesV({
+			MutableBytesView(&part1[0], part1.size()),
+			MutableBytesView(&part2[0], part2.size()),
+		});
+		ASSERT_EQ(readSize, testingString.size() * 2 - 1);
+		ASSERT_EQ(
+			part1 + part2.substr(0, readSize - part1.size()),
+			(testingString + testingString).substr(1)
+		);
+		ASSERT_EQ(file->Tell(), testingString.size() * 2);
+		readSize = file->ReadAtV(
+			testingString.size(),
+			{ MutableBytesView(&part1[0], part1.size()), }
+		);
+		ASSERT_EQ(readSize, part1.size());
+		ASSERT_EQ(part1, "Hello");
+		file->Seek(1);
+
+		// views point into the mapping
+		ASSERT_EQ(file->GetView(0, 1).data(), file->GetView().data());
+
+		// seeking before the beginning is not allowed
+		ASSERT_THROW(file->Seek(-1, SeekWhence::Begin), Exception);
+	}
+
+	{
+		auto file = SysCall::MMapRBinaryFile::Open(
+			fileName,
+			SysCall::AccessHint::Random
+		);
+		ASSERT_EQ(
+			file->GetView().Copy<std::string>(),
+			testingString + testingString
+		);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, MMapBinaryReadEmptyFile)
+{
+	std::string fileName = GenRandomFileName();
+
+	{
+		auto file = SysCall::WBinaryFile::Create(fileName);
+	}
+
+	{
+		auto file = SysCall::MMapRBinaryFile::Open(
+			fileName,
+			SysCall::AccessHint::WillNeed
+		);
+		ASSERT_EQ(file->GetFileSize(), 0);
+		ASSERT_EQ(file->ReadBytes<std::string>(), std::string());
+		ASSERT_TRUE(file->ReadView().empty());
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, MMapBinaryInPlaceWrite)
+{
+	std::string fileName = GenRandomFileName();
+
+	std::vector<uint8_t> expected(100000, 0);
+	{
+		auto file = SysCall::MMapRWBinaryFile::Create(
+			fileName,
+			8192,
+			SysCall::MMapSyncMode::Async
+		);
+		ASSERT_EQ(file->GetFileSize(), 0);
+		ASSERT_EQ(file->GetSyncMode(), SysCall::MMapSyncMode::Async);
+
+		// many tiny random writes, through the pointer API, spanning many
+		// growth steps
+		std::mt19937 gen(1234);
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			size_t offset = gen() % (expected.size() - 8);
+			uint64_t value = gen();
+			std::memcpy(file->GetWritePtr(offset, 8), &value, 8);
+			std::memcpy(&expected[offset], &value, 8);
+		}
+		// the file is extended to cover the last byte written so far
+		std::memcpy(file->GetWritePtr(expected.size() - 1, 1), "\x7F", 1);
+		expected.back() = 0x7F;
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+		ASSERT_EQ(file->Tell(), 0);
+
+		// writable views advance the position
+		MutableBytesView view = file->WriteView(4);
+		std::memcpy(view.data(), "ABCD", 4);
+		std::memcpy(&expected[0], "ABCD", 4);
+		ASSERT_EQ(file->Tell(), 4);
+
+		ASSERT_EQ(
+			file->GetView(0, expected.size() * 2).size(),
+			expected.size()
+		);
+
+		// reserving does not change the size
+		file->Reserve(expected.size() * 2);
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+
+		file->Flush();
+		file->SyncRange(10, 5000, SysCall::MMapSyncMode::Sync);
+		file->SetSyncMode(SysCall::MMapSyncMode::Sync);
+	}
+
+	{
+		// the padding is trimmed when the file is closed
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), expected);
+	}
+
+	{
+		// the content is kept when an existing file is opened
+		auto file = SysCall::MMapRWBinaryFile::Open(fileName);
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+		ASSERT_EQ(file->Tell(), 0);
+		ASSERT_EQ(
+			file->ReadAt<std::vector<uint8_t> >(0, 10),
+			std::vector<uint8_t>(expected.begin(), expected.begin() + 10)
+		);
+
+		// writing past the end leaves a gap of zeros
+		file->Seek(expected.size() + 10);
+		file->WriteBytes(std::string("end"));
+		expected.resize(expected.size() + 10, 0);
+		expected.insert(expected.end(), {'e', 'n', 'd'});
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->ReadBytes<std::vector<uint8_t> >(), expected);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, WriteBehindWriteThenRead)
+{
+	std::string fileName = GenRandomFileName();
+
+	ASSERT_THROW(
+		SysCall::WriteBehindWBinaryFile::Create(fileName, 1000, 1);,
+		Exception
+	);
+
+	std::string expected;
+	{
+		// small buffers, so most writes go across buffers
+		auto file = SysCall::WriteBehindWBinaryFile::Create(fileName, 1000, 3);
+		ASSERT_EQ(file->GetBufferSize(), 1000);
+
+		for (size_t i = 0; i < 2000; ++i)
+		{
+			std::string record = "record-" + std::to_string(i) + ";";
+			file->WriteBytes(record);
+			expected += record;
+		}
+		std::string large(5555, 'L');
+		file->WriteBytesV({
+			ConstBytesView(large.data(), large.size()),
+			ConstBytesView(large.data(), 10),
+		});
+		expected += large + large.substr(0, 10);
+		ASSERT_EQ(file->Tell(), expected.size());
+
+		// flush is the synchronization point
+		file->Flush();
+		ASSERT_EQ(file->GetNumPending(), 0);
+		{
+			auto checkFile = SysCall::RBinaryFile::Open(fileName);
+			ASSERT_EQ(checkFile->ReadBytes<std::string>(), expected);
+		}
+
+		// positional writes land after the pending data
+		file->WriteBytes(std::string("tail"));
+		expected += "tail";
+		file->WriteAt(3, std::string("ABC"));
+		expected.replace(3, 3, "ABC");
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+		ASSERT_EQ(file->Tell(), expected.size());
+
+		file->Seek(1);
+		file->WriteBytes(std::string("xy"));
+		expected.replace(1, 2, "xy");
+		ASSERT_EQ(file->Tell(), 3);
+	}
+
+	{
+		// pending data is written when the stream is closed
+		auto file = SysCall::WriteBehindWBinaryFile::Append(fileName, 64, 2);
+		for (size_t i = 0; i < 100; ++i)
+		{
+			file->WriteBytes(std::string("append;"));
+			expected += "append;";
+		}
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->ReadBytes<std::string>(), expected);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, RecordFileReadWrite)
+{
+	std::string fileName = GenRandomFileName();
+
+	ASSERT_THROW(SysCall::RecordFile::Create(fileName, 0);, Exception);
+
+	for (size_t interval : { 1, 3, 16 })
+	{
+		std::vector<std::string> records;
+		{
+			auto file = SysCall::RecordFile::Create(fileName, interval);
+			for (size_t i = 0; i < 100; ++i)
+			{
+				records.push_back(std::string(i % 7, 'a') + std::to_string(i));
+				file->Append(records.back());
+			}
+			records.push_back(std::string());
+			file->Append(records.back());
+			ASSERT_EQ(file->GetNumRecords(), records.size());
+
+			file->Close();
+			ASSERT_THROW(file->Append(std::string("x"));, Exception);
+		}
+
+		auto file = SysCall::RecordFile::Open(fileName);
+		ASSERT_EQ(file->GetNumRecords(), records.size());
+
+		// the records are framed the same way as `SizedSendBytes`
+		ASSERT_EQ(file->GetRecordOffset(0), 0);
+		ASSERT_EQ(file->GetRecordOffset(1), 8 + records[0].size());
+
+		// random access
+		for (size_t i : { 50, 0, 99, 100, 1, 17, 48 })
+		{
+			ASSERT_EQ(file->Get<std::string>(i), records[i]);
+		}
+		ASSERT_THROW(file->Get<std::string>(records.size());, Exception);
+
+		// sequential
+		std::string record;
+		for (size_t i = 0; i < records.size(); ++i)
+		{
+			ASSERT_EQ(file->TellRecord(), i);
+			ASSERT_TRUE(file->Next(record));
+			ASSERT_EQ(record, records[i]);
+		}
+		ASSERT_FALSE(file->Next(record));
+
+		file->SeekRecord(98);
+		ASSERT_TRUE(file->Next(record));
+		ASSERT_EQ(record, records[98]);
+		// random access does not move the sequential position
+		ASSERT_EQ(file->Get<std::string>(3), records[3]);
+		ASSERT_TRUE(file->Next(record));
+		ASSERT_EQ(record, records[99]);
+
+		file->SeekRecord(records.size());
+		ASSERT_FALSE(file->Next(record));
+		ASSERT_THROW(file->SeekRecord(records.size() + 1);, Exception);
+	}
+
+	{
+		// an empty record file
+		SysCall::RecordFile::Create(fileName);
+		auto file = SysCall::RecordFile::Open(fileName);
+		ASSERT_EQ(file->GetNumRecords(), 0);
+		std::string record;
+		ASSERT_FALSE(file->Next(record));
+	}
+
+	{
+		// not a record file
+		auto file = SysCall::WBinaryFile::Create(fileName);
+		file->WriteBytes(std::string(100, 'x'));
+	}
+	ASSERT_THROW(SysCall::RecordFile::Open(fileName);, Exception);
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+GTEST_TEST(TestDiskFiles, AlignedBufferPool)
+{
+	ASSERT_THROW(SysCall::AlignedBufferPool::Create(4096, 100), Exception);
+	ASSERT_THROW(SysCall::AlignedBufferPool::Create(0, 4096), Exception);
+
+	auto pool = SysCall::AlignedBufferPool::Create(5000, 4096, 1);
+	ASSERT_EQ(pool->GetBufferSize(), 8192);
+	ASSERT_EQ(pool->GetAlignment(), 4096);
+	ASSERT_EQ(pool->GetNumCached(), 0);
+
+	uint8_t* cachedPtr = nullptr;
+	{
+		auto buf1 = pool->Acquire();
+		auto buf2 = pool->Acquire();
+		ASSERT_EQ(buf1.size(), 8192);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(buf1.data()) % 4096, 0);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(buf2.data()) % 4096, 0);
+		cachedPtr = buf2.data();
+
+		// only one buffer is kept after both are released
+		buf2.Reset();
+		ASSERT_EQ(buf2.data(), nullptr);
+		ASSERT_EQ(pool->GetNumCached(), 1);
+	}
+	ASSERT_EQ(pool->GetNumCached(), 1);
+
+	// released buffers are reused; buffers may outlive the pool pointer
+	SysCall::AlignedBuffer buf = pool->Acquire();
+	ASSERT_EQ(buf.data(), cachedPtr);
+	ASSERT_EQ(pool->GetNumCached(), 0);
+	pool.reset();
+	buf.data()[0] = 1;
+}
+
+
+GTEST_TEST(TestDiskFiles, DirectBinaryWriteThenRead)
+{
+	std::string fileName = GenRandomFileName();
+
+	// small buffers so requests are split into multiple chunks
+	auto pool = SysCall::AlignedBufferPool::Create(8192, 4096);
+
+	std::string testingString = "Hello, world!";
+	std::string largeString(20000, '\0');
+	for (size_t i = 0; i < largeString.size(); ++i)
+	{
+		largeString[i] = static_cast<char>('a' + (i % 26));
+	}
+	std::string expected = testingString + largeString;
+
+	{
+		auto file = SysCall::DirectWBinaryFile::Create(fileName, pool);
+
+		// unaligned writes
+		file->WriteBytes(testingString);
+		ASSERT_EQ(file->Tell(), testingString.size());
+		file->WriteBytes(largeString);
+		ASSERT_EQ(file->Tell(), expected.size());
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+
+		// overwrite in the middle, across a block boundary
+		file->WriteAt(4090, std::string("0123456789"));
+		expected.replace(4090, 10, "0123456789");
+		ASSERT_EQ(file->Tell(), expected.size());
+
+		// the size on the disk is trimmed on flush
+		file->Flush();
+		auto checkFile = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(checkFile->GetFileSize(), expected.size());
+	}
+
+	{
+		auto file = SysCall::DirectWBinaryFile::Append(fileName, pool);
+		ASSERT_EQ(file->Tell(), expected.size());
+		file->WriteBytes(testingString);
+		expected += testingString;
+
+		// aligned write with a buffer from the pool
+		auto buf = pool->Acquire();
+		std::memset(buf.data(), 'z', buf.size());
+		file->WriteAtV(16384, { ConstBytesView(buf.GetView()) });
+		ASSERT_EQ(file->Tell(), expected.size());
+		expected.replace(16384, buf.size(), std::string(buf.size(), 'z'));
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+
+		// appending always writes to the end
+		file->Seek(0);
+		file->WriteBytes(testingString);
+		expected += testingString;
+		ASSERT_EQ(file->Tell(), expected.size());
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(file->ReadBytes<std::string>(), expected);
+	}
+
+	{
+		auto file = SysCall::DirectRBinaryFile::Open(fileName, pool);
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+
+		// unaligned reads
+		ASSERT_EQ(
+			file->ReadBytes<std::string>(testingString.size()),
+			testingString
+		);
+		ASSERT_EQ(file->Tell(), testingString.size());
+		ASSERT_EQ(
+			file->ReadBytes<std::string>(),
+			expected.substr(testingString.size())
+		);
+		ASSERT_EQ(file->ReadBytes<std::string>(10), std::string());
+		ASSERT_EQ(file->ReadAt<std::string>(4085, 20), expected.substr(4085, 20));
+
+		// aligned read into a buffer from the pool
+		auto buf = pool->Acquire();
+		file->Seek(8192);
+		size_t readSize = file->ReadBytesV({ buf.GetView() });
+		ASSERT_EQ(readSize, buf.size());
+		ASSERT_EQ(
+			std::string(buf.data(), buf.data() + readSize),
+			expected.substr(8192, buf.size())
+		);
+
+		// aligned read hitting the end of the file
+		readSize = file->ReadAtV(20480, { buf.GetView() });
+		ASSERT_EQ(readSize, expected.size() - 20480);
+		ASSERT_EQ(
+			std::string(buf.data(), buf.data() + readSize),
+			expected.substr(20480)
+		);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+GTEST_TEST(TestDiskFiles, GroupCommitLog)
+{
+	std::string fileName = GenRandomFileName();
+
+	const size_t numThreads = 8;
+	const size_t numRecordsPerThread = 100;
+
+	{
+		auto log = SysCall::GroupCommitLog::Open(fileName);
+
+		// concurrent producers waiting for their own records
+		std::vector<std::thread> producers;
+		for (size_t i = 0; i < numThreads; ++i)
+		{
+			producers.emplace_back(
+				[&log, i, numRecordsPerThread]()
+				{
+					for (size_t j = 0; j < numRecordsPerThread; ++j)
+					{
+						log->AppendSync(std::vector<uint8_t>({
+							static_cast<uint8_t>(i),
+							static_cast<uint8_t>(j),
+						}));
+					}
+				}
+			);
+		}
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		auto content = file->ReadBytes<std::vector<uint8_t> >();
+		ASSERT_EQ(content.size(), numThreads * numRecordsPerThread * 2);
+
+		// records of each producer are in the order they are submitted
+		std::vector<size_t> nextSeq(numThreads, 0);
+		for (size_t i = 0; i < content.size(); i += 2)
+		{
+			ASSERT_LT(content[i], numThreads);
+			ASSERT_EQ(content[i + 1], nextSeq[content[i]]);
+			++nextSeq[content[i]];
+		}
+	}
+
+	{
+		// the commit window is long enough to be held until a group is
+		// full, so the grouping does not depend on the scheduling: 50
+		// records of 2 bytes are committed in 2 groups capped at 50 bytes
+		const size_t numRecords = 50;
+		auto log = SysCall::GroupCommitLog::Open(
+			fileName,
+			std::chrono::seconds(60),
+			numRecords
+		);
+
+		std::atomic<size_t> numDurable(0);
+		std::promise<void> allDurable;
+		std::future<void> allDurableFuture = allDurable.get_future();
+		for (size_t i = 0; i < numRecords; ++i)
+		{
+			log->Append(
+				std::vector<uint8_t>({ 0xFF, static_cast<uint8_t>(i) }),
+				[&numDurable, &allDurable, numRecords](bool hasErrorOccurred)
+				{
+					EXPECT_FALSE(hasErrorOccurred);
+					if (++numDurable == numRecords)
+					{
+						allDurable.set_value();
+					}
+				}
+			);
+		}
+		allDurableFuture.wait();
+		ASSERT_EQ(log->GetNumCommits(), 2);
+
+		// committed when the log is closed, without waiting out the window
+		log->Append(std::vector<uint8_t>({ 0xFF, 0xFF }), nullptr);
+	}
+
+	{
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		ASSERT_EQ(
+			file->GetFileSize(),
+			(numThreads * numRecordsPerThread + 51) * 2
+		);
+	}
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+
+#ifdef SIMPLESYSIO_SYSCALL_HAS_IO_URING
+
+GTEST_TEST(TestDiskFiles, AsyncBinaryWriteThenRead)
+{
+	std::shared_ptr<SysCall::IOUringEngine> engine;
+	try
+	{
+		engine = SysCall::IOUringEngine::Create(8);
+	}
+	catch (const Exception&)
+	{
+		// io_uring may be disabled in the testing environment
+		GTEST_SKIP();
+	}
+
+	std::string fileName = GenRandomFileName();
+	const size_t chunkSize = 4096;
+	const size_t numChunks = 64;
+
+	std::vector<uint8_t> expected(chunkSize * numChunks);
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		expected[i] = static_cast<uint8_t>((i * 7) + (i / chunkSize));
+	}
+
+	{
+		auto file = SysCall::AsyncWBinaryFile::Create(fileName, engine);
+
+		// more chunks than the ring entries, so submissions are batched
+		size_t numWritten = 0;
+		for (size_t i = 0; i < numChunks; ++i)
+		{
+			file->AsyncWrite(
+				i * chunkSize,
+				std::vector<uint8_t>(
+					expected.begin() + (i * chunkSize),
+					expected.begin() + ((i + 1) * chunkSize)
+				),
+				[&numWritten, chunkSize](std::vector<uint8_t> buf, bool hasErr)
+				{
+					EXPECT_FALSE(hasErr);
+					EXPECT_EQ(buf.size(), chunkSize);
+					++numWritten;
+				}
+			);
+		}
+		engine->Wait(numChunks);
+		ASSERT_EQ(numWritten, numChunks);
+		ASSERT_EQ(engine->GetNumInFlight(), 0);
+
+		bool isSynced = false;
+		file->AsyncFsync(
+			true,
+			[&isSynced](std::vector<uint8_t> buf, bool hasErr)
+			{
+				EXPECT_FALSE(hasErr);
+				EXPECT_TRUE(buf.empty());
+				isSynced = true;
+			}
+		);
+		ASSERT_EQ(engine->Wait(), 1);
+		ASSERT_TRUE(isSynced);
+
+		// the position of the synchronous interface is not affected
+		ASSERT_EQ(file->Tell(), 0);
+	}
+
+	{
+		auto file = SysCall::AsyncRBinaryFile::Open(fileName, engine);
+		ASSERT_EQ(file->GetFileSize(), expected.size());
+
+		// many small reads in flight at the same time
+		const size_t readSize = 100;
+		std::vector<std::vector<uint8_t> > results(expected.size() / readSize);
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			file->AsyncRead(
+				i * readSize,
+				readSize,
+				[&results, i](std::vector<uint8_t> buf, bool hasErr)
+				{
+					EXPECT_FALSE(hasErr);
+					results[i] = std::move(buf);
+				}
+			);
+		}
+		while (engine->GetNumInFlight() > 0)
+		{
+			engine->Wait();
+		}
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			ASSERT_EQ(
+				results[i],
+				std::vector<uint8_t>(
+					expected.begin() + (i * readSize),
+					expected.begin() + ((i + 1) * readSize)
+				)
+			);
+		}
+
+		// reads are shortened at the end of the file
+		std::vector<uint8_t> tail;
+		file->AsyncRead(
+			expected.size() - 10,
+			100,
+			[&tail](std::vector<uint8_t> buf, bool hasErr)
+			{
+				EXPECT_FALSE(hasErr);
+				tail = std::move(buf);
+			}
+		);
+		engine->Submit();
+		while (engine->Poll() == 0)
+		{}
+		ASSERT_EQ(
+			tail,
+			std::vector<uint8_t>(expected.end() - 10, expected.end())
+		);
+	}
+
+	{
+		auto file = SysCall::AsyncRWBinaryFile::Append(fileName, engine);
+		bool isErr = false;
+		file->AsyncRead(
+			0,
+			10,
+			[&isErr](std::vector<uint8_t>, bool hasErr)
+			{
+				isErr = hasErr;
+			}
+		);
+		engine->Wait();
+		ASSERT_FALSE(isErr);
+	}
+
+	{
+		// a callback that throws does not hold back the rest of its batch
+		auto throwingEngine = SysCall::IOUringEngine::Create(8);
+		auto file = SysCall::AsyncRBinaryFile::Open(fileName, throwingEngine);
+
+		const size_t numReads = 4;
+		size_t numCalled = 0;
+		for (size_t i = 0; i < numReads; ++i)
+		{
+			file->AsyncRead(
+				i * 10,
+				10,
+				[&numCalled, i](std::vector<uint8_t>, bool hasErr)
+				{
+					EXPECT_FALSE(hasErr);
+					++numCalled;
+					if (i == 1)
+					{
+						throw std::runtime_error("callback failed");
+					}
+				}
+			);
+		}
+		throwingEngine->Submit();
+		// give the kernel time to complete all of them, so they are likely
+		// handled in one batch
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		size_t numThrown = 0;
+		while (throwingEngine->GetNumInFlight() > 0)
+		{
+			try
+			{
+				throwingEngine->Wait();
+			}
+			catch (const std::runtime_error&)
+			{
+				++numThrown;
+			}
+		}
+		ASSERT_EQ(numCalled, numReads);
+		ASSERT_EQ(numThrown, 1);
+
+		// the engine can still be closed with operations in flight
+		file->AsyncRead(
+			0,
+			10,
+			[](std::vector<uint8_t>, bool)
+			{
+				throw std::runtime_error("not called");
+			}
+		);
+		throwingEngine->Submit();
+		file.reset();
+		throwingEngine.reset();
+	}
+
+	ASSERT_THROW(
+		SysCall::AsyncRBinaryFile::Open(fileName, nullptr),
+		Exception
+	);
+
+	// Clean up the testing file
+	remove(fileName.c_str());
+}
+
+#endif // SIMPLESYSIO_SYSCALL_HAS_IO_URING
+
+#endif // !defined(_WIN32)
+
 #endif // SIMPLESYSIO_ENABLE_SYSCALL_FILESYSTEM
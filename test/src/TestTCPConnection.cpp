@@ -5,11 +5,20 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include <thread>
 
 #include <boost/asio/executor_work_guard.hpp>
 
+#include <SimpleSysIO/BufferedBinaryIOS.hpp>
+#include <SimpleSysIO/BufferedStreamSocket.hpp>
+#include <SimpleSysIO/ChecksumStreamSocket.hpp>
+#include <SimpleSysIO/SysCall/Files.hpp>
 #include <SimpleSysIO/SysCall/TCPSocket.hpp>
 #include <SimpleSysIO/SysCall/TCPAcceptor.hpp>
 
@@ -143,6 +152,41 @@ static void TestSendAndReceive(StreamSocketBase& clt, StreamSocketBase& srv)
 	EXPECT_EQ(testStr, recvSomeStr);
 
 
+	// RecvInto & RecvSomeInto
+	clt.SendBytes(testStr);
+	clt.SendBytes(testStr);
+	clt.SendBytes(testStr);
+	std::string recvIntoStr(5, '\0');
+	srv.RecvInto(MutableBytesView(&recvIntoStr[0], recvIntoStr.size()));
+	EXPECT_EQ(recvIntoStr, testStr.substr(0, 5));
+	UninitBytesVector recvIntoVec;
+	recvIntoVec.reserve(testStr.size() * 2);
+	const uint8_t* recvIntoPtr = recvIntoVec.data();
+	srv.RecvInto(recvIntoVec, testStr.size() - 5);
+	while(recvIntoVec.size() < testStr.size() * 2 - 5)
+	{
+		srv.RecvSomeInto(
+			recvIntoVec,
+			testStr.size() * 2 - 5 - recvIntoVec.size()
+		);
+	}
+	// no reallocation happened
+	EXPECT_EQ(recvIntoVec.data(), recvIntoPtr);
+	EXPECT_EQ(
+		std::string(recvIntoVec.begin(), recvIntoVec.end()),
+		testStr.substr(5) + testStr
+	);
+	size_t recvIntoSize = 0;
+	while (recvIntoSize < testStr.size())
+	{
+		recvIntoSize += srv.RecvSomeInto(MutableBytesView(
+			&recvIntoStr[0],
+			recvIntoStr.size()
+		));
+	}
+	EXPECT_EQ(recvIntoSize, testStr.size());
+
+
 	// SizedSendBytes & SizedRecvBytes
 	std::vector<uint8_t> testVec = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
 	clt.SizedSendBytes(testVec);
@@ -173,6 +217,414 @@ TEST_F(TestingServerV6, SendAndReceive)
 }
 
 
+TEST_F(TestingServerV4, SendBytesV)
+{
+	std::unique_ptr<StreamSocketBase> client = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", m_acceptor->GetLocalPort()
+	);
+	AfterClientConnected();
+
+	// more segments than one gathered write takes
+	std::vector<std::string> parts;
+	std::vector<ConstBytesView> segments;
+	std::string expected;
+	for (size_t i = 0; i < 40; ++i)
+	{
+		parts.push_back(std::string(i % 3, 'x') + std::to_string(i));
+	}
+	for (const auto& part : parts)
+	{
+		segments.push_back(
+			ConstBytesView(
+				reinterpret_cast<const uint8_t*>(part.data()),
+				part.size()
+			)
+		);
+		expected += part;
+	}
+	client->SendBytesV(segments);
+	EXPECT_EQ(
+		m_testSocket->RecvBytes<std::string>(expected.size()),
+		expected
+	);
+
+	std::string header = "head:";
+	std::string body = "body";
+	m_testSocket->SendBytesV({
+		ConstBytesView(
+			reinterpret_cast<const uint8_t*>(header.data()),
+			header.size()
+		),
+		ConstBytesView(),
+		ConstBytesView(
+			reinterpret_cast<const uint8_t*>(body.data()),
+			body.size()
+		),
+	});
+	EXPECT_EQ(client->RecvBytes<std::string>(9), "head:body");
+
+	// the size and the data are sent together
+	client->SizedSendBytes(std::string("Hello, world!"));
+	client->SizedSendBytes<std::string, uint16_t>(body);
+	client->SizedSendBytes(std::string());
+	EXPECT_EQ(m_testSocket->RecvBytes<std::string>(8 + 13).substr(8),
+		"Hello, world!");
+	EXPECT_EQ(m_testSocket->RecvPrimitive<uint16_t>(), 4);
+	EXPECT_EQ(m_testSocket->RecvBytes<std::string>(4), "body");
+	EXPECT_EQ(m_testSocket->SizedRecvBytes<std::string>(), "");
+}
+
+
+TEST_F(TestingServerV4, BufferedRecv)
+{
+	std::unique_ptr<StreamSocketBase> client = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", m_acceptor->GetLocalPort()
+	);
+	AfterClientConnected();
+
+	EXPECT_THROW(BufferedStreamSocket(nullptr), Exception);
+
+	BufferedStreamSocket srvSocket(std::move(m_testSocket), 64);
+	EXPECT_EQ(srvSocket.GetBufferSize(), 64);
+
+	// many small fields
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		client->SendPrimitive<uint32_t>(i);
+		client->SendPrimitive<uint8_t>(static_cast<uint8_t>(i));
+		client->SizedSendBytes(std::to_string(i));
+	}
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		EXPECT_EQ(srvSocket.PeekPrimitive<uint32_t>(), i);
+		EXPECT_EQ(srvSocket.RecvPrimitive<uint32_t>(), i);
+		EXPECT_EQ(srvSocket.RecvPrimitive<uint8_t>(), static_cast<uint8_t>(i));
+		EXPECT_EQ(srvSocket.SizedRecvBytes<std::string>(), std::to_string(i));
+	}
+	EXPECT_EQ(srvSocket.GetNumBuffered(), 0);
+
+	// peek, skip, and receives larger than the buffer
+	std::string large(1000, 'L');
+	client->SendBytes(std::string("head"));
+	client->SendBytes(large);
+	client->SendBytes(std::string("tail"));
+	ConstBytesView peeked = srvSocket.Peek(4);
+	EXPECT_EQ(std::string(peeked.begin(), peeked.end()), "head");
+	EXPECT_THROW(srvSocket.Peek(65), Exception);
+	srvSocket.Skip(2);
+	EXPECT_EQ(srvSocket.RecvBytes<std::string>(2), "ad");
+	EXPECT_EQ(srvSocket.RecvBytes<std::string>(large.size()), large);
+	EXPECT_EQ(srvSocket.RecvBytes<std::string>(4), "tail");
+
+	// a peek across the end of the buffer
+	client->SendBytes(std::string(60, 'a'));
+	client->SendBytes(std::string("0123456789"));
+	srvSocket.Skip(59);
+	peeked = srvSocket.Peek(11);
+	EXPECT_EQ(std::string(peeked.begin(), peeked.end()), "a0123456789");
+	srvSocket.Skip(11);
+
+	// sends are passed through
+	srvSocket.SizedSendBytes(std::string("reply"));
+	EXPECT_EQ(client->SizedRecvBytes<std::string>(), "reply");
+}
+
+
+TEST_F(TestingServerV4, Checksum)
+{
+	std::unique_ptr<StreamSocketBase> client = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", m_acceptor->GetLocalPort()
+	);
+	AfterClientConnected();
+
+	ChecksumStreamSocket cltSocket(std::move(client));
+	ChecksumStreamSocket srvSocket(std::move(m_testSocket));
+
+	// checksums are updated as the data goes through
+	TestSendAndReceive(cltSocket, srvSocket);
+	EXPECT_EQ(cltSocket.GetSendChecksum(), srvSocket.GetRecvChecksum());
+	EXPECT_NE(cltSocket.GetSendChecksum(), 0);
+	EXPECT_EQ(cltSocket.GetRecvChecksum(), 0);
+
+	std::string testStr = "Hello, world!";
+	cltSocket.ResetSendChecksum();
+	srvSocket.ResetRecvChecksum();
+	srvSocket.SendBytes(testStr);
+	EXPECT_EQ(cltSocket.RecvBytes<std::string>(testStr.size()), testStr);
+	EXPECT_EQ(
+		cltSocket.GetRecvChecksum(),
+		CRC32C::Compute(testStr.data(), testStr.size())
+	);
+	EXPECT_EQ(cltSocket.GetRecvChecksum(), srvSocket.GetSendChecksum());
+
+	// gathered sends are covered as well
+	cltSocket.ResetSendChecksum();
+	srvSocket.ResetRecvChecksum();
+	cltSocket.SizedSendBytes(testStr);
+	EXPECT_EQ(srvSocket.SizedRecvBytes<std::string>(), testStr);
+	EXPECT_EQ(cltSocket.GetSendChecksum(), srvSocket.GetRecvChecksum());
+
+	// checksummed frames
+	ChecksumSocketFrame::Send(cltSocket, testStr);
+	ChecksumSocketFrame::Send(cltSocket, std::string());
+	EXPECT_EQ(ChecksumSocketFrame::Recv<std::string>(srvSocket), testStr);
+	EXPECT_EQ(ChecksumSocketFrame::Recv<std::string>(srvSocket), "");
+
+	// a frame with a wrong checksum
+	uint8_t header[ChecksumFrame::sk_headerSize];
+	ChecksumFrame::MakeHeader(header, testStr.data(), testStr.size());
+	cltSocket.SendBytes(ConstBytesView(header, sizeof(header)));
+	cltSocket.SendBytes(std::string("Hello, World!"));
+	EXPECT_THROW(
+		ChecksumSocketFrame::Recv<std::string>(srvSocket),
+		Exception
+	);
+
+	// frames larger than the limit are refused before the payload is
+	// received
+	ChecksumFrame::MakeHeader(header, testStr.data(), testStr.size());
+	header[0] = 0xF0U;
+	header[1] = 0xFFU;
+	header[2] = 0xFFU;
+	header[3] = 0xFFU;
+	cltSocket.SendBytes(ConstBytesView(header, sizeof(header)));
+	EXPECT_THROW(
+		ChecksumSocketFrame::Recv<std::string>(srvSocket),
+		Exception
+	);
+	ChecksumSocketFrame::Send(cltSocket, testStr);
+	EXPECT_THROW(
+		ChecksumSocketFrame::Recv<std::string>(
+			srvSocket,
+			testStr.size() - 1
+		),
+		Exception
+	);
+}
+
+
+static std::vector<uint8_t> WriteSendFileTestData(const std::string& fileName)
+{
+	// larger than the socket buffers, so the sender has to wait
+	std::vector<uint8_t> data(3 * 1024 * 1024 + 321);
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		data[i] = static_cast<uint8_t>((i * 7) ^ (i >> 12));
+	}
+	auto file = SysCall::WBinaryFile::Create(fileName);
+	file->WriteBytes(data);
+	return data;
+}
+
+
+TEST_F(TestingServerV4, SendFile)
+{
+	auto client = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", m_acceptor->GetLocalPort()
+	);
+	AfterClientConnected();
+
+	const std::string fileName =
+		"TestTCPConnection_SendFile_" +
+		std::to_string(m_acceptor->GetLocalPort());
+	std::vector<uint8_t> data = WriteSendFileTestData(fileName);
+
+	std::vector<std::unique_ptr<RBinaryIOSBase> > files;
+	// sent by the kernel
+	files.push_back(SysCall::RBinaryFile::OpenFD(fileName));
+	files.push_back(SysCall::RBinaryFile::Open(fileName));
+	// sent through the user space
+	files.push_back(
+		std::unique_ptr<RBinaryIOSBase>(new BufferedRBinaryIOS(
+			SysCall::RBinaryFile::OpenFD(fileName)
+		))
+	);
+
+	for (auto& file : files)
+	{
+		std::vector<uint8_t> recvData;
+		std::thread recvThread([&]()
+			{
+				recvData =
+					m_testSocket->RecvBytes<std::vector<uint8_t> >(data.size());
+			}
+		);
+		EXPECT_EQ(client->SendFile(*file), data.size());
+		recvThread.join();
+		EXPECT_EQ(recvData, data);
+		// the position of the file is not moved
+		EXPECT_EQ(file->Tell(), 0);
+
+		// partial range, and range cut at the end of the file
+		EXPECT_EQ(client->SendFile(*file, 10, 20), 20);
+		EXPECT_EQ(client->SendFile(*file, data.size() - 5, 100), 5);
+		EXPECT_EQ(client->SendFile(*file, data.size(), 100), 0);
+		recvData = m_testSocket->RecvBytes<std::vector<uint8_t> >(25);
+		std::vector<uint8_t> expData(data.begin() + 10, data.begin() + 30);
+		expData.insert(expData.end(), data.end() - 5, data.end());
+		EXPECT_EQ(recvData, expData);
+	}
+
+	files.clear();
+	remove(fileName.c_str());
+}
+
+
+TEST_F(TestingServerV4, RecvToFile)
+{
+	auto client = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", m_acceptor->GetLocalPort()
+	);
+	AfterClientConnected();
+
+	const std::string fileName =
+		"TestTCPConnection_RecvToFile_" +
+		std::to_string(m_acceptor->GetLocalPort());
+	std::vector<uint8_t> data = WriteSendFileTestData(fileName);
+	const std::string header = "header";
+
+	using WFileCreator = std::function<std::unique_ptr<WBinaryIOSBase>()>;
+	std::vector<WFileCreator> creators = {
+		// spliced by the kernel
+		[&]() -> std::unique_ptr<WBinaryIOSBase>
+		{
+			return SysCall::WBinaryFile::CreateFD(fileName);
+		},
+		[&]() -> std::unique_ptr<WBinaryIOSBase>
+		{
+			return SysCall::WBinaryFile::Create(fileName);
+		},
+		// splice is not supported in the append mode
+		[&]() -> std::unique_ptr<WBinaryIOSBase>
+		{
+			remove(fileName.c_str());
+			return SysCall::WBinaryFile::AppendFD(fileName);
+		},
+		// received through the user space
+		[&]() -> std::unique_ptr<WBinaryIOSBase>
+		{
+			return std::unique_ptr<WBinaryIOSBase>(new BufferedWBinaryIOS(
+				SysCall::WBinaryFile::CreateFD(fileName)
+			));
+		},
+	};
+
+	for (const auto& creator : creators)
+	{
+		{
+			auto file = creator();
+			file->WriteBytes(header);
+
+			std::thread sendThread([&]()
+				{
+					m_testSocket->SendBytes(data);
+					m_testSocket->SendBytes(header);
+				}
+			);
+			EXPECT_EQ(client->RecvToFile(*file, data.size()), data.size());
+			sendThread.join();
+			EXPECT_EQ(file->Tell(), header.size() + data.size());
+
+			// the position is moved forward
+			EXPECT_EQ(client->RecvToFile(*file, header.size()), header.size());
+		}
+
+		auto file = SysCall::RBinaryFile::Open(fileName);
+		std::vector<uint8_t> expData(header.begin(), header.end());
+		expData.insert(expData.end(), data.begin(), data.end());
+		expData.insert(expData.end(), header.begin(), header.end());
+		EXPECT_EQ(file->ReadBytes<std::vector<uint8_t> >(), expData);
+	}
+
+	remove(fileName.c_str());
+}
+
+
+TEST(TestTCPConnection, AsyncSendFile)
+{
+	std::shared_ptr<boost::asio::io_service> ioService =
+		std::make_shared<boost::asio::io_service>();
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+		workGuard = boost::asio::make_work_guard(*ioService);
+	std::thread ioThread([&]()
+		{
+			ioService->run();
+		}
+	);
+
+	auto acceptor = SysCall::TCPAcceptor::BindV4("127.0.0.1", 0, ioService);
+	std::unique_ptr<StreamSocketBase> testSvrSocket;
+	std::atomic_bool isAccepted(false);
+	acceptor->AsyncAccept(
+		[&](std::unique_ptr<StreamSocketBase> socket, bool hasErrorOccurred)
+		{
+			if (!hasErrorOccurred)
+			{
+				testSvrSocket = std::move(socket);
+				isAccepted = true;
+			}
+		}
+	);
+	auto testCltSocket = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", acceptor->GetLocalPort(), ioService
+	);
+	// wait for connection
+	while(!isAccepted)
+	{}
+
+	const std::string fileName =
+		"TestTCPConnection_AsyncSendFile_" +
+		std::to_string(acceptor->GetLocalPort());
+	std::vector<uint8_t> data = WriteSendFileTestData(fileName);
+
+	std::vector<std::unique_ptr<RBinaryIOSBase> > files;
+	files.push_back(SysCall::RBinaryFile::OpenFD(fileName));
+	files.push_back(
+		std::unique_ptr<RBinaryIOSBase>(new BufferedRBinaryIOS(
+			SysCall::RBinaryFile::OpenFD(fileName)
+		))
+	);
+
+	for (auto& file : files)
+	{
+		std::atomic_bool isSent(false);
+		size_t sentSize = 0;
+		bool hasSendError = true;
+		testCltSocket->AsyncSendFile(
+			*file,
+			100,
+			data.size(),
+			[&](size_t sent, bool hasErrorOccurred)
+			{
+				sentSize = sent;
+				hasSendError = hasErrorOccurred;
+				isSent = true;
+			}
+		);
+
+		std::vector<uint8_t> recvData =
+			testSvrSocket->RecvBytes<std::vector<uint8_t> >(data.size() - 100);
+		// wait for the callback
+		while(!isSent)
+		{}
+
+		EXPECT_FALSE(hasSendError);
+		EXPECT_EQ(sentSize, data.size() - 100);
+		EXPECT_EQ(
+			recvData,
+			std::vector<uint8_t>(data.begin() + 100, data.end())
+		);
+	}
+
+	files.clear();
+	remove(fileName.c_str());
+
+	// stop io service
+	ioService->stop();
+	ioThread.join();
+}
+
+
 TEST(TestTCPConnection, AsyncAccept)
 {
 	std::shared_ptr<boost::asio::io_service> ioService =
@@ -355,6 +807,278 @@ TEST(TestTCPConnection, AsyncRecv)
 }
 
 
+TEST(TestTCPConnection, AsyncRecvPooled)
+{
+	std::shared_ptr<boost::asio::io_service> ioService =
+		std::make_shared<boost::asio::io_service>();
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+		workGuard = boost::asio::make_work_guard(*ioService);
+	std::thread ioThread([&]()
+		{
+			ioService->run();
+		}
+	);
+
+	// Construct server and client sockets
+	auto acceptor = SysCall::TCPAcceptor::BindV4("127.0.0.1", 0, ioService);
+	std::unique_ptr<StreamSocketBase> testSvrSocket;
+	std::atomic_bool isAccepted(false);
+	acceptor->AsyncAccept(
+		[&](std::unique_ptr<StreamSocketBase> socket, bool hasErrorOccurred)
+		{
+			if (!hasErrorOccurred)
+			{
+				testSvrSocket = std::move(socket);
+				isAccepted = true;
+			}
+		}
+	);
+	auto testCltSocket = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", acceptor->GetLocalPort(), ioService
+	);
+	// wait for connection
+	while(!isAccepted)
+	{}
+	SysCall::TCPSocket& svrSocket =
+		dynamic_cast<SysCall::TCPSocket&>(*testSvrSocket);
+
+	// a pool owned by the socket is created on demand
+	size_t defBufSize = SysCall::TCPSocket::sk_defRecvPoolBufferSize;
+	ASSERT_EQ(testCltSocket->GetRecvBufferPool()->GetBufferSize(), defBufSize);
+
+	// a pool shared by both sockets
+	auto pool = SysCall::AlignedBufferPool::Create(1024, 64, 1);
+	testCltSocket->SetRecvBufferPool(pool);
+	svrSocket.SetRecvBufferPool(pool);
+
+	std::string testStr = "Hello World!";
+	for (size_t i = 0; i < 3; ++i)
+	{
+		std::atomic_bool isRecv(false);
+		std::string recvStr;
+		const uint8_t* bufPtr = nullptr;
+		svrSocket.AsyncRecvPooled(
+			[&](SysCall::AlignedBuffer buf, size_t size, bool hasErrorOccurred)
+			{
+				if (!hasErrorOccurred)
+				{
+					recvStr.assign(reinterpret_cast<char*>(buf.data()), size);
+					bufPtr = buf.data();
+					buf.Reset();
+					isRecv = true;
+				}
+			}
+		);
+		testCltSocket->SendBytes(testStr);
+		// wait for recv
+		while(!isRecv)
+		{}
+
+		EXPECT_GT(recvStr.size(), 0);
+		EXPECT_TRUE(testStr.find(recvStr) == 0);
+		// the buffer is back in the pool once it's released
+		EXPECT_EQ(pool->GetNumCached(), 1);
+		// and it's reused by the next receive
+		auto buf = pool->Acquire();
+		EXPECT_EQ(buf.data(), bufPtr);
+		buf.Reset();
+
+		// consume the rest, if the message was split
+		if (recvStr.size() < testStr.size())
+		{
+			svrSocket.RecvBytes<std::string>(testStr.size() - recvStr.size());
+		}
+	}
+
+	// the buffer can be kept beyond the callback
+	std::atomic_bool isRecv(false);
+	SysCall::AlignedBuffer keptBuf;
+	size_t keptSize = 0;
+	testCltSocket->AsyncRecvPooled(
+		[&](SysCall::AlignedBuffer buf, size_t size, bool hasErrorOccurred)
+		{
+			if (!hasErrorOccurred)
+			{
+				keptBuf = std::move(buf);
+				keptSize = size;
+				isRecv = true;
+			}
+		}
+	);
+	svrSocket.SendBytes(testStr);
+	while(!isRecv)
+	{}
+	EXPECT_EQ(pool->GetNumCached(), 0);
+	EXPECT_TRUE(
+		testStr.find(
+			std::string(reinterpret_cast<char*>(keptBuf.data()), keptSize)
+		) == 0
+	);
+	keptBuf.Reset();
+	EXPECT_EQ(pool->GetNumCached(), 1);
+
+	// stop io service
+	ioService->stop();
+	ioThread.join();
+}
+
+
+TEST(TestTCPConnection, AsyncSend)
+{
+	std::shared_ptr<boost::asio::io_service> ioService =
+		std::make_shared<boost::asio::io_service>();
+	boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+		workGuard = boost::asio::make_work_guard(*ioService);
+	// exceptions thrown by callbacks come out of `run()`
+	std::atomic<size_t> numThrown(0);
+	std::thread ioThread([&]()
+		{
+			while (true)
+			{
+				try
+				{
+					ioService->run();
+					return;
+				}
+				catch (const std::runtime_error&)
+				{
+					++numThrown;
+				}
+			}
+		}
+	);
+
+	// Construct server and client sockets
+	auto acceptor = SysCall::TCPAcceptor::BindV4("127.0.0.1", 0, ioService);
+	std::unique_ptr<StreamSocketBase> testSvrSocket;
+	std::atomic_bool isAccepted(false);
+	acceptor->AsyncAccept(
+		[&](std::unique_ptr<StreamSocketBase> socket, bool hasErrorOccurred)
+		{
+			if (!hasErrorOccurred)
+			{
+				testSvrSocket = std::move(socket);
+				isAccepted = true;
+			}
+		}
+	);
+	auto testCltSocket = SysCall::TCPSocket::ConnectV4(
+		"127.0.0.1", acceptor->GetLocalPort(), ioService
+	);
+	// wait for connection
+	while(!isAccepted)
+	{}
+
+	// many sends queued at once go out in order
+	const size_t numMsgs = 1000;
+	std::atomic<size_t> numDone(0);
+	std::atomic<size_t> numBytes(0);
+	std::atomic_bool hasError(false);
+	auto callback = [&](size_t sent, bool hasErrorOccurred)
+	{
+		numBytes += sent;
+		hasError = hasError || hasErrorOccurred;
+		++numDone;
+	};
+	std::string expected;
+	for (size_t i = 0; i < numMsgs; ++i)
+	{
+		std::string msg = "msg-" + std::to_string(i) + ";";
+		testCltSocket->AsyncSendBytes(msg, callback);
+		expected += msg;
+	}
+	testCltSocket->AsyncSizedSendBytes(std::string("sized"), callback);
+	testCltSocket->AsyncSendPrimitive<uint32_t>(0x01020304U, callback);
+	testCltSocket->AsyncSendBytes(std::vector<uint8_t>({ 'e', 'n', 'd' }));
+
+	EXPECT_EQ(
+		testSvrSocket->RecvBytes<std::string>(expected.size()),
+		expected
+	);
+	EXPECT_EQ(testSvrSocket->SizedRecvBytes<std::string>(), "sized");
+	EXPECT_EQ(testSvrSocket->RecvPrimitive<uint32_t>(), 0x01020304U);
+	EXPECT_EQ(testSvrSocket->RecvBytes<std::string>(3), "end");
+
+	while(numDone < numMsgs + 2)
+	{}
+	EXPECT_FALSE(hasError);
+	EXPECT_EQ(numBytes, expected.size() + 8 + 5 + 4);
+
+	// a callback that throws does not stall the queue
+	testCltSocket->AsyncSendBytes(
+		std::string("throw"),
+		[](size_t, bool)
+		{
+			throw std::runtime_error("callback failed");
+		}
+	);
+	while(numThrown == 0)
+	{}
+	std::atomic_bool isSentAfter(false);
+	testCltSocket->AsyncSendBytes(
+		std::string("after"),
+		[&](size_t sent, bool hasErrorOccurred)
+		{
+			isSentAfter = (sent == 5) && !hasErrorOccurred;
+		}
+	);
+	EXPECT_EQ(testSvrSocket->RecvBytes<std::string>(10), "throwafter");
+	while(!isSentAfter)
+	{}
+
+	// nor does it skip the other callbacks of the same batch; the io
+	// thread is held, so the three sends are queued into one batch
+	std::atomic_bool isHeld(true);
+	boost::asio::post(
+		*ioService,
+		[&isHeld]()
+		{
+			while(isHeld)
+			{}
+		}
+	);
+	std::atomic<size_t> numBatchDone(0);
+	auto batchCallback = [&numBatchDone](size_t, bool hasErrorOccurred)
+	{
+		EXPECT_FALSE(hasErrorOccurred);
+		++numBatchDone;
+	};
+	testCltSocket->AsyncSendBytes(std::string("a"), batchCallback);
+	testCltSocket->AsyncSendBytes(
+		std::string("b"),
+		[&numBatchDone](size_t, bool)
+		{
+			++numBatchDone;
+			throw std::runtime_error("callback failed");
+		}
+	);
+	testCltSocket->AsyncSendBytes(std::string("c"), batchCallback);
+	isHeld = false;
+	EXPECT_EQ(testSvrSocket->RecvBytes<std::string>(3), "abc");
+	while(numBatchDone < 3)
+	{}
+	while(numThrown < 2)
+	{}
+
+	// sockets without a write queue send on the calling thread
+	ChecksumStreamSocket cltSocket(std::move(testCltSocket));
+	bool isSent = false;
+	cltSocket.AsyncSendBytes(
+		std::string("sync"),
+		[&](size_t sent, bool hasErrorOccurred)
+		{
+			isSent = (sent == 4) && !hasErrorOccurred;
+		}
+	);
+	EXPECT_TRUE(isSent);
+	EXPECT_EQ(testSvrSocket->RecvBytes<std::string>(4), "sync");
+
+	// stop io service
+	ioService->stop();
+	ioThread.join();
+}
+
+
 TEST(TestTCPConnection, AsyncRecvFill)
 {
 	std::shared_ptr<boost::asio::io_service> ioService =
@@ -485,6 +1209,35 @@ TEST(TestTCPConnection, AsyncRecvFill)
 	);
 
 
+	// A large message arriving in many segments
+	std::vector<uint8_t> largeData(4 * 1024 * 1024 + 123);
+	for (size_t i = 0; i < largeData.size(); ++i)
+	{
+		largeData[i] = static_cast<uint8_t>(i * 7);
+	}
+	recvData.clear();
+	isRecv = false;
+	testCltSocket->AsyncRecvRawUntilComplete(
+		largeData.size(),
+		[&](std::vector<uint8_t> buf, bool hasErrorOccurred)
+		{
+			if (!hasErrorOccurred)
+			{
+				recvData = std::move(buf);
+				isRecv = true;
+			}
+		}
+	);
+	for (size_t i = 0; i < largeData.size(); i += 100000)
+	{
+		size_t size = std::min<size_t>(100000, largeData.size() - i);
+		testSvrSocket->SendBytes(ConstBytesView(largeData.data() + i, size));
+	}
+	while(!isRecv)
+	{}
+	EXPECT_TRUE(recvData == largeData);
+
+
 	// stop io service
 	ioService->stop();
 	ioThread.join();